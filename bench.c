@@ -0,0 +1,526 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "grafo.h"
+
+//------------------------------------------------------------------------------
+// uso: bench [-f csv|json] [-g gerador] [-n n1,n2,...] [-o ordem] [-r repeticoes]
+//             [-s semente]
+//
+// gera grafos sintéticos de n vértices (default: 1000, 10000 e 100000) e
+// mede, para cada um, le_grafo(), emparelhamento_maximo() (só nos
+// bipartidos), busca_largura_lexicografica(), cordal(), cliques_maximais()
+// (só nos cordais), simplicial() (e portanto clique()) em todos os
+// vértices, com e sem indexa_adjacencia(), e escreve_grafo()
+//
+// com -o largura, -o rcm ou -o grau, o grafo é reordenado por
+// reordena_grafo() logo depois de lido (e a reordenação também é medida)
+//
+// para cada medida escreve o menor tempo das repetições, o tempo por aresta,
+// o pico de memória residente do processo até ali e o número de alocações
+// (malloc, calloc e realloc) de uma execução
+//
+// as alocações só são contadas se o programa for ligado com
+//
+//     -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc
+//
+// (ver o alvo bench do makefile)
+
+//------------------------------------------------------------------------------
+// contagem de alocações
+
+static unsigned long alocacoes = 0;
+
+void *__real_malloc(size_t tam);
+void *__real_calloc(size_t n, size_t tam);
+void *__real_realloc(void *p, size_t tam);
+void *__wrap_malloc(size_t tam);
+void *__wrap_calloc(size_t n, size_t tam);
+void *__wrap_realloc(void *p, size_t tam);
+
+void *__wrap_malloc(size_t tam) {
+
+  __atomic_fetch_add(&alocacoes, 1, __ATOMIC_RELAXED);
+  return __real_malloc(tam);
+}
+
+void *__wrap_calloc(size_t n, size_t tam) {
+
+  __atomic_fetch_add(&alocacoes, 1, __ATOMIC_RELAXED);
+  return __real_calloc(n, tam);
+}
+
+void *__wrap_realloc(void *p, size_t tam) {
+
+  __atomic_fetch_add(&alocacoes, 1, __ATOMIC_RELAXED);
+  return __real_realloc(p, tam);
+}
+
+//------------------------------------------------------------------------------
+// gerador pseudo-aleatório (xorshift64*)
+
+static uint64_t semente = 88172645463325252ull;
+
+static uint64_t aleatorio(void) {
+
+  semente ^= semente >> 12;
+  semente ^= semente << 25;
+  semente ^= semente >> 27;
+
+  return semente * 2685821657736338717ull;
+}
+
+// inteiro uniforme em [0, n)
+static unsigned int uniforme(unsigned int n) {
+
+  return (unsigned int)(aleatorio() % n);
+}
+
+// real uniforme em (0, 1]
+static double real(void) {
+
+  return (double)((aleatorio() >> 11) + 1) / 9007199254740992.0;
+}
+
+//------------------------------------------------------------------------------
+// geradores: escrevem em f um grafo não direcionado de (cerca de) n vértices
+// no formato dot
+
+// G(n/2, n/2, p) bipartido, com grau médio 8; a%u à esquerda, b%u à direita
+static void gera_bipartido(FILE *f, unsigned int n) {
+
+  unsigned int n1 = n / 2, n2 = n - n / 2;
+  double p = n2 > 8 ? 8.0 / n2 : 1.0, salto;
+  uint64_t total = (uint64_t)n1 * n2, w;
+
+  for ( unsigned int i = 0; i < n1; ++i )
+    fprintf(f, "  a%u\n", i);
+  for ( unsigned int i = 0; i < n2; ++i )
+    fprintf(f, "  b%u\n", i);
+
+  // os pares escolhidos são sorteados pelo tamanho do salto entre eles.
+  for ( w = 0; w < total; ++w ) {
+
+    if ( p < 1.0 ) {
+      salto = floor(log(real()) / log(1.0 - p));
+      if ( salto >= (double)(total - w) )
+        break;
+      w += (uint64_t)salto;
+    }
+    fprintf(f, "  a%u -- b%u\n", (unsigned int)(w / n2), (unsigned int)(w % n2));
+  }
+}
+
+// k-árvore aleatória (cordal), k = 3
+static void gera_k_arvore(FILE *f, unsigned int n) {
+
+  const unsigned int k = 3;
+  unsigned int *cliques, c, j;
+
+  for ( unsigned int v = 0; v < n; ++v )
+    fprintf(f, "  v%u\n", v);
+  for ( unsigned int v = 0; v < n && v <= k; ++v )
+    for ( unsigned int u = 0; u < v; ++u )
+      fprintf(f, "  v%u -- v%u\n", u, v);
+  if ( n <= k + 1 )
+    return;
+
+  // cada vértice novo é ligado a k vértices de uma (k+1)-clique sorteada e
+  // forma com eles uma nova (k+1)-clique.
+  cliques = malloc(sizeof(unsigned int) * (k + 1) * (n - k));
+  for ( j = 0; j <= k; ++j )
+    cliques[j] = j;
+  for ( unsigned int v = k + 1; v < n; ++v ) {
+
+    c = uniforme(v - k);
+    j = uniforme(k + 1);
+    memcpy(cliques + (v - k) * (k + 1), cliques + c * (k + 1), sizeof(unsigned int) * (k + 1));
+    cliques[(v - k) * (k + 1) + j] = v;
+    for ( unsigned int i = 0; i <= k; ++i )
+      if ( i != j )
+        fprintf(f, "  v%u -- v%u\n", cliques[c * (k + 1) + i], v);
+  }
+  free(cliques);
+}
+
+struct intervalo {
+
+  double esq, dir;
+  unsigned int id;
+  int padding;
+};
+
+static int compara_intervalos(const void *a, const void *b) {
+
+  const struct intervalo *x = a, *y = b;
+
+  return (x->esq > y->esq) - (x->esq < y->esq);
+}
+
+// grafo de intervalos (cordal): n intervalos com início uniforme em [0, n) e
+// comprimento uniforme em [0, 8), grau médio 8
+static void gera_intervalos(FILE *f, unsigned int n) {
+
+  struct intervalo *iv = malloc(sizeof(struct intervalo) * (n ? n : 1));
+
+  for ( unsigned int v = 0; v < n; ++v ) {
+    iv[v].esq = real() * n;
+    iv[v].dir = iv[v].esq + 8.0 * real();
+    iv[v].id = v;
+    fprintf(f, "  v%u\n", v);
+  }
+  qsort(iv, n, sizeof(struct intervalo), compara_intervalos);
+  for ( unsigned int i = 0; i < n; ++i )
+    for ( unsigned int j = i + 1; j < n && iv[j].esq <= iv[i].dir; ++j )
+      fprintf(f, "  v%u -- v%u\n", iv[i].id, iv[j].id);
+  free(iv);
+}
+
+// grade l x l, com l = teto(raiz(n)) (bipartida: a%u e b%u pela paridade)
+static void gera_grade(FILE *f, unsigned int n) {
+
+  unsigned int l = 1;
+
+  while ( l * l < n )
+    ++l;
+
+#define CASA(i, j)  (((i) + (j)) % 2 ? 'b' : 'a'), (i) * l + (j)
+  for ( unsigned int i = 0; i < l; ++i )
+    for ( unsigned int j = 0; j < l; ++j ) {
+      fprintf(f, "  %c%u\n", CASA(i, j));
+      if ( j + 1 < l )
+        fprintf(f, "  %c%u -- %c%u\n", CASA(i, j), CASA(i, j + 1));
+      if ( i + 1 < l )
+        fprintf(f, "  %c%u -- %c%u\n", CASA(i, j), CASA(i + 1, j));
+    }
+#undef CASA
+}
+
+// caminho de n vértices (bipartido: a%u e b%u pela paridade)
+static void gera_caminho(FILE *f, unsigned int n) {
+
+  for ( unsigned int v = 0; v < n; ++v ) {
+    fprintf(f, "  %c%u\n", v % 2 ? 'b' : 'a', v);
+    if ( v )
+      fprintf(f, "  %c%u -- %c%u\n", v % 2 ? 'a' : 'b', v - 1, v % 2 ? 'b' : 'a', v);
+  }
+}
+
+// ligação preferencial (Barabási-Albert): cada vértice novo se liga a 2
+// vértices distintos sorteados com probabilidade proporcional ao grau
+static void gera_lei_potencia(FILE *f, unsigned int n) {
+
+  unsigned int *pontas = malloc(sizeof(unsigned int) * 4 * (n + 1)), np = 0, u, w;
+
+  for ( unsigned int v = 0; v < n; ++v ) {
+
+    fprintf(f, "  v%u\n", v);
+    if ( v == 1 ) {
+      fprintf(f, "  v0 -- v1\n");
+      pontas[np++] = 0;
+      pontas[np++] = 1;
+    }
+    else if ( v > 1 ) {
+      u = pontas[uniforme(np)];
+      do
+        w = pontas[uniforme(np)];
+      while ( w == u && v > 2 );
+      fprintf(f, "  v%u -- v%u\n", u, v);
+      if ( w != u )
+        fprintf(f, "  v%u -- v%u\n", w, v);
+      pontas[np++] = u;
+      pontas[np++] = v;
+      pontas[np++] = w;
+      pontas[np++] = v;
+    }
+  }
+  free(pontas);
+}
+
+typedef void (*funcao_geradora)(FILE *f, unsigned int n);
+
+static const struct {
+
+  const char *nome;
+  funcao_geradora gera;
+  int bipartido;
+  int padding;
+} geradores[] = {
+  { "bipartido",    gera_bipartido,     1, 0 },
+  { "k_arvore",     gera_k_arvore,      0, 0 },
+  { "intervalos",   gera_intervalos,    0, 0 },
+  { "grade",        gera_grade,         1, 0 },
+  { "caminho",      gera_caminho,       1, 0 },
+  { "lei_potencia", gera_lei_potencia,  0, 0 },
+};
+
+#define N_GERADORES (sizeof(geradores) / sizeof(geradores[0]))
+
+//------------------------------------------------------------------------------
+// operações medidas
+
+struct caso {
+
+  char *texto;            // o grafo no formato dot
+  size_t tam;
+  grafo g;
+  grafo lixo;             // grafo a desalocar depois da medida
+  vertice *v;             // os vértices de g
+  unsigned int n;
+  int padding;
+  FILE *nulo;             // /dev/null, para escreve_grafo()
+};
+
+static void mede_le_grafo(struct caso *c) {
+
+  FILE *f = fmemopen(c->texto, c->tam, "r");
+
+  c->lixo = c->g;
+  c->g = le_grafo(f);
+  fclose(f);
+}
+
+static void mede_emparelhamento(struct caso *c) {
+
+  c->lixo = emparelhamento_maximo(c->g);
+}
+
+static void mede_lexbfs(struct caso *c) {
+
+  destroi_lista(busca_largura_lexicografica(c->g), NULL);
+}
+
+static void mede_cordal(struct caso *c) {
+
+  cordal(c->g);
+}
+
+static void mede_cliques(struct caso *c) {
+
+  lista l = cliques_maximais(c->g);
+
+  if ( l )
+    destroi_lista(l, destroi_clique);
+}
+
+static void mede_simplicial(struct caso *c) {
+
+  for ( unsigned int i = 0; i < c->n; ++i )
+    simplicial(c->v[i], c->g);
+}
+
+static void mede_escreve_grafo(struct caso *c) {
+
+  escreve_grafo(c->nulo, c->g);
+}
+
+static const char *nomes_ordem[] = { "largura", "rcm", "grau" };
+static int ordem = -1;
+
+static void mede_reordena(struct caso *c) {
+
+  reordena_grafo(c->g, ordem);
+}
+
+typedef void (*operacao)(struct caso *c);
+
+//------------------------------------------------------------------------------
+// saída
+
+static int json = 0, primeira_linha = 1;
+
+static void escreve_medida(const char *gerador, unsigned int n, unsigned int m,
+                           const char *op, unsigned int repeticoes, double ns,
+                           long rss, unsigned long aloc) {
+
+  double por_aresta = ns / (m ? m : 1);
+  const char *o = ordem < 0 ? "original" : nomes_ordem[ordem];
+
+  if ( json )
+    printf("%s  {\"gerador\": \"%s\", \"n\": %u, \"m\": %u, \"ordem\": \"%s\", "
+           "\"operacao\": \"%s\", \"repeticoes\": %u, \"tempo_ns\": %.0f, "
+           "\"ns_por_aresta\": %.2f, \"rss_kb\": %ld, \"alocacoes\": %lu}",
+           primeira_linha ? "" : ",\n", gerador, n, m, o, op, repeticoes, ns,
+           por_aresta, rss, aloc);
+  else {
+    if ( primeira_linha )
+      printf("gerador,n,m,ordem,operacao,repeticoes,tempo_ns,ns_por_aresta,rss_kb,alocacoes\n");
+    printf("%s,%u,%u,%s,%s,%u,%.0f,%.2f,%ld,%lu\n", gerador, n, m, o, op, repeticoes, ns,
+           por_aresta, rss, aloc);
+  }
+  primeira_linha = 0;
+}
+
+static double agora_ns(void) {
+
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+
+  return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+// executa op repeticoes vezes sobre c e escreve o menor tempo
+
+static void mede(const char *gerador, struct caso *c, const char *nome,
+                 operacao op, unsigned int repeticoes) {
+
+  struct rusage uso;
+  double t, melhor = -1;
+  unsigned long aloc = 0;
+
+  for ( unsigned int r = 0; r < repeticoes; ++r ) {
+
+    aloc = alocacoes;
+    t = agora_ns();
+    op(c);
+    t = agora_ns() - t;
+    aloc = alocacoes - aloc;
+    if ( melhor < 0 || t < melhor )
+      melhor = t;
+    if ( c->lixo ) {
+      destroi_grafo(c->lixo);
+      c->lixo = NULL;
+    }
+  }
+  getrusage(RUSAGE_SELF, &uso);
+  escreve_medida(gerador, n_vertices(c->g), n_arestas(c->g), nome, repeticoes, melhor,
+                 uso.ru_maxrss, aloc);
+}
+
+//------------------------------------------------------------------------------
+// gera o grafo de n vértices de geradores[i] e faz todas as medidas
+
+static void executa(unsigned int i, unsigned int n, unsigned int repeticoes, FILE *nulo) {
+
+  struct caso c;
+  char nome[32];
+  FILE *f;
+
+  memset(&c, 0, sizeof(struct caso));
+  c.nulo = nulo;
+  f = open_memstream(&c.texto, &c.tam);
+  fprintf(f, "graph %s {\n", geradores[i].nome);
+  geradores[i].gera(f, n);
+  fprintf(f, "}\n");
+  fclose(f);
+
+  mede_le_grafo(&c);
+  if ( !c.g ) {
+    fprintf(stderr, "bench: %s(%u) não foi lido\n", geradores[i].nome, n);
+    free(c.texto);
+    return;
+  }
+  mede(geradores[i].nome, &c, "le_grafo", mede_le_grafo, repeticoes);
+  if ( ordem >= 0 )
+    mede(geradores[i].nome, &c, "reordena_grafo", mede_reordena, repeticoes);
+  c.n = n_vertices(c.g);
+
+  // os vértices são obtidos antes das medidas; os nomes são os do gerador.
+  c.v = malloc(sizeof(vertice) * (c.n ? c.n : 1));
+  for ( unsigned int j = 0, k = 0; k < c.n; ++j ) {
+    snprintf(nome, sizeof(nome), "v%u", j);
+    if ( (c.v[k] = busca_vertice_nome(nome, c.g)) ) { ++k; continue; }
+    snprintf(nome, sizeof(nome), "a%u", j);
+    if ( (c.v[k] = busca_vertice_nome(nome, c.g)) ) ++k;
+    snprintf(nome, sizeof(nome), "b%u", j);
+    if ( k < c.n && (c.v[k] = busca_vertice_nome(nome, c.g)) ) ++k;
+  }
+
+  if ( geradores[i].bipartido )
+    mede(geradores[i].nome, &c, "emparelhamento_maximo", mede_emparelhamento, repeticoes);
+  mede(geradores[i].nome, &c, "busca_largura_lexicografica", mede_lexbfs, repeticoes);
+  mede(geradores[i].nome, &c, "cordal", mede_cordal, repeticoes);
+  if ( cordal(c.g) )
+    mede(geradores[i].nome, &c, "cliques_maximais", mede_cliques, repeticoes);
+  mede(geradores[i].nome, &c, "simplicial", mede_simplicial, repeticoes);
+  indexa_adjacencia(c.g);
+  mede(geradores[i].nome, &c, "simplicial_indexado", mede_simplicial, repeticoes);
+  mede(geradores[i].nome, &c, "escreve_grafo", mede_escreve_grafo, repeticoes);
+
+  destroi_grafo(c.g);
+  free(c.v);
+  free(c.texto);
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+
+  const char *so = NULL, *tamanhos = "1000,10000,100000";
+  unsigned int repeticoes = 1;
+  const char *p;
+  char *fim;
+  unsigned long n;
+  FILE *nulo;
+  int i;
+
+  for ( i = 1; i < argc; ++i ) {
+
+    if ( strcmp(argv[i], "-f") == 0 && i + 1 < argc )
+      json = strcmp(argv[++i], "json") == 0;
+    else if ( strcmp(argv[i], "-g") == 0 && i + 1 < argc )
+      so = argv[++i];
+    else if ( strcmp(argv[i], "-n") == 0 && i + 1 < argc )
+      tamanhos = argv[++i];
+    else if ( strcmp(argv[i], "-r") == 0 && i + 1 < argc )
+      repeticoes = (unsigned int)atoi(argv[++i]);
+    else if ( strcmp(argv[i], "-s") == 0 && i + 1 < argc )
+      semente = strtoull(argv[++i], NULL, 10) | 1;
+    else if ( strcmp(argv[i], "-o") == 0 && i + 1 < argc ) {
+      ++i;
+      for ( ordem = 2; ordem >= 0 && strcmp(argv[i], nomes_ordem[ordem]) != 0; --ordem );
+      if ( ordem < 0 )
+        break;
+    }
+    else
+      break;
+  }
+  if ( i < argc ) {
+    fprintf(stderr, "uso: %s [-f csv|json] [-g gerador] [-n n1,n2,...] "
+            "[-o largura|rcm|grau] [-r repeticoes] [-s semente]\n", argv[0]);
+    return 1;
+  }
+  if ( !repeticoes )
+    repeticoes = 1;
+  for ( i = 0; so && i < (int)N_GERADORES && strcmp(so, geradores[i].nome) != 0; ++i );
+  if ( i == (int)N_GERADORES ) {
+    fprintf(stderr, "%s: gerador desconhecido: %s; use", argv[0], so);
+    for ( i = 0; i < (int)N_GERADORES; ++i )
+      fprintf(stderr, " %s", geradores[i].nome);
+    fprintf(stderr, "\n");
+    return 1;
+  }
+
+  if ( !(nulo = fopen("/dev/null", "w")) ) {
+    perror("/dev/null");
+    return 1;
+  }
+
+  if ( json )
+    printf("[\n");
+  for ( unsigned int g = 0; g < N_GERADORES; ++g ) {
+
+    if ( so && strcmp(so, geradores[g].nome) != 0 )
+      continue;
+    for ( p = tamanhos; *p; p = *fim ? fim + 1 : fim ) {
+      n = strtoul(p, &fim, 10);
+      if ( fim == p )
+        break;
+      executa(g, (unsigned int)n, repeticoes, nulo);
+      fflush(stdout);
+    }
+  }
+  if ( json )
+    printf("%s]\n", primeira_linha ? "" : "\n");
+
+  fclose(nulo);
+
+  return 0;
+}
@@ -18,11 +18,18 @@
  * =====================================================================================
  */
 
+#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
 #include <stdlib.h>
 #define __USE_XOPEN_EXTENDED
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <pthread.h>
 #include <graphviz/cgraph.h>
 #include "grafo.h"
 
@@ -39,15 +46,27 @@ typedef int bool;
 #define FALSE		0
 #endif
 
-//------------------------------------------------------------------------------
-// Enumeração com os estados de um vértice.
-// Não setado, visitado ou inserido.
+// Índice inválido de vértice/aresta.
+#define NENHUM		UINT_MAX
+
+// A libcgraph não é reentrante: le_grafo() só a usa com esta trava.
+static pthread_mutex_t trava_cgraph = PTHREAD_MUTEX_INITIALIZER;
 
-typedef enum __state {
-	eNotSet = 0,
-	eVisited,
-	eInserted
-}eState;
+// Consultas concorrentes sobre um grafo alterado refazem a CSR com esta trava.
+static pthread_mutex_t trava_csr = PTHREAD_MUTEX_INITIALIZER;
+
+// Estatísticas (ver grafo.h): ESTAT(x) só compila x com GRAFO_ESTATISTICAS.
+// Os laços contam em variáveis locais, somadas aos contadores globais
+// (atomicamente) uma vez por chamada.
+#ifdef GRAFO_ESTATISTICAS
+static struct estatisticas estat;
+#define ESTAT(...)			__VA_ARGS__
+#else
+#define ESTAT(...)
+#endif
+#define CONTA(campo, n)		ESTAT(__atomic_add_fetch(&estat.campo, (unsigned long)(n), __ATOMIC_RELAXED))
+#define INICIO(t)			ESTAT(unsigned long t = relogio_ns())
+#define FIM(campo, t)		CONTA(campo, relogio_ns() - (t))
 
 
 //---------------------------------------------------------------------------
@@ -66,6 +85,24 @@ struct lista {
   unsigned int tamanho;
   int padding; // só pra evitar warning
   no primeiro;
+  struct arena *arena; // de onde vêm os nós, ou NULL (malloc)
+};
+
+//------------------------------------------------------------------------------
+// Arena: memória de um grafo (vértices, nomes, arestas, listas e seus nós)
+// alocada em poucos blocos grandes e desalocada de uma vez.
+struct bloco {
+	struct bloco*	b_prox;
+	size_t			b_tam;
+};
+
+struct arena {
+	struct bloco*	a_blocos;		// bloco corrente é o primeiro.
+	char*			a_livre;		// início da parte livre do bloco corrente.
+	size_t			a_resta;		// bytes livres no bloco corrente.
+	size_t			a_proximo;		// tamanho do próximo bloco.
+	no				a_nos;			// nós removidos, para reúso.
+	struct aresta*	a_arestas;		// arestas removidas, para reúso (ligadas por a_dst).
 };
 
 //------------------------------------------------------------------------------
@@ -80,43 +117,123 @@ struct lista {
 // num grafo com pesos nas arestas todas as arestas tem peso, que é um long int
 //
 // o peso default de uma aresta é 0
+
+//------------------------------------------------------------------------------
+// Vizinhança compactada (CSR): os vizinhos do vértice de índice v ocupam as
+// posições [c_inicio[v], c_inicio[v+1]) dos vetores c_viz, c_aresta e c_peso.
+//
+// Os vetores são só para leitura: a CSR de um grafo lido por
+// le_grafo_binario() está no mapeamento (PROT_READ) do snapshot. Quem constrói
+// uma CSR preenche seus próprios vetores antes de pô-los aqui.
+struct csr {
+	const UINT*	c_inicio;	// n+1 deslocamentos.
+	const UINT*	c_viz;		// índice do vizinho.
+	const UINT*	c_aresta;	// índice da aresta.
+	const LINT*	c_peso;		// peso da aresta.
+};
+
+//------------------------------------------------------------------------------
+// Índice nome -> vértice: tabela hash de endereçamento aberto (sondagem
+// linear) com capacidade potência de 2.
+struct indice {
+	vertice*	i_vert;		// vértice do slot, ou NULL se livre.
+	UINT*		i_hash;		// hash do nome do vértice do slot.
+	UINT		i_mascara;	// capacidade - 1.
+	UINT		i_n;		// número de slots ocupados.
+};
+
+//------------------------------------------------------------------------------
+// Índice de adjacência: conjunto dos pares (u,w) de índices de vértices tais
+// que w está na vizinhança (de saída) de u, numa tabela hash de
+// endereçamento aberto com capacidade potência de 2.
+struct adjacencia {
+	uint64_t*	a_chaves;	// (u << 32) | w, ou ADJ_LIVRE.
+	UINT		a_mascara;	// capacidade - 1.
+	bool		a_ativo;	// indexa_adjacencia() foi chamada.
+};
+
+#define ADJ_LIVRE	UINT64_MAX
+
+//------------------------------------------------------------------------------
+// Texto de entrada de le_grafo(): mapeado em memória, se input é um arquivo
+// regular, ou lido inteiro para um buffer.
+struct entrada {
+	char*	e_buf;			// texto a partir da posição corrente de input.
+	size_t	e_tam;
+	void*	e_mapa;			// arquivo mapeado, ou NULL se o texto foi lido.
+	size_t	e_tam_mapa;
+	off_t	e_pos;			// posição de input onde o texto começa.
+};
+
+//------------------------------------------------------------------------------
+// Estado de varre_dot(), para continuar a varredura quando chega mais texto.
+struct varredura_dot {
+	size_t	vd_i;			// posição onde continuar.
+	UINT	vd_prof;		// profundidade de chaves.
+	bool	vd_conteudo;	// já apareceu algo além de brancos e comentários.
+};
+
 struct grafo {
     UINT    g_nvertices;
     UINT    g_naresta;
     int     g_tipo;
     bool	g_ponderado;
+    bool	g_csr_mapeada;   // a CSR está no snapshot binário (g_mapa).
+    bool	g_csr_pronta;    // CSR e índice de adjacência válidos (ver garante_csr()).
     char*	g_nome;
     lista   g_vertices;      // lista de vértices.
+    struct vertice** g_v;    // vértices indexados por v_id.
+    struct aresta**  g_a;    // arestas indexadas por a_id.
+    struct csr g_out;        // vizinhança (de saída, se direcionado).
+    struct csr g_in;         // vizinhança de entrada (somente direcionado).
+    struct indice g_indice;  // índice dos vértices pelo nome.
+    struct adjacencia g_adj; // índice de adjacência (indexa_adjacencia()).
+    struct entrada g_mapa;   // snapshot binário de onde g foi carregado.
+    struct arena g_arena;    // vértices, nomes, arestas e listas de g.
+    size_t  g_pico_aux;      // maior área de trabalho de um algoritmo em g.
 };
 
 struct vertice {
     char*	v_nome;
-    int*	v_lbl;
-    eState	v_visitado;
-    int		v_index;
     bool	v_covered;		// O vertice esta coberto pelo emparelhamento?
-    int		padding;
+    UINT	v_id;			// índice do vértice em g_v e na CSR.
     lista	v_neighborhood_in;
     lista	v_neighborhood_out;
 };
 
 struct aresta {
 	bool	a_ponderado;
-	eState	a_visitada;
+	int		padding;
     LINT	a_peso;
     bool	a_covered;		// A aresta esta coberta pelo emparelhamento?
-    int		padding;
+    UINT	a_id;			// índice da aresta em g_a.
     vertice	a_orig;         // tail
     vertice	a_dst;          // head
 };
 typedef struct aresta *aresta;
 
-typedef struct __heap {
-	int 		elem;
-	int 		pos;
-	vertice*	v;
-}HEAP;
-typedef HEAP* PHEAP;
+//------------------------------------------------------------------------------
+// Contexto de consulta: área de trabalho dos algoritmos que só leem o grafo,
+// de forma que consultas com contextos distintos podem ser feitas ao mesmo
+// tempo no mesmo grafo.
+struct consulta {
+	UINT*	c_vet;
+	size_t	c_tam;			// em UINTs.
+};
+
+//------------------------------------------------------------------------------
+// Estado de Hopcroft-Karp, indexado pelo índice dos vértices.
+struct emparelhamento {
+	UINT*	par;			// vértice emparelhado com v, ou NENHUM.
+	UINT*	aresta;			// aresta que emparelha v, ou NENHUM.
+	UINT*	dist;			// camada de v na fase corrente, ou NENHUM.
+	UINT*	fila;			// fila da busca em largura.
+	UINT*	cursor;			// próxima posição da vizinhança de v a examinar.
+	UINT*	pilha;			// caminho corrente de get_path().
+	unsigned char* lado;	// 0 (esquerda) ou 1 (direita).
+	UINT	limite;			// comprimento dos caminhos aumentantes da fase.
+	UINT	padding;
+};
 
 /*
  * MACROS AUXILIARES
@@ -128,31 +245,47 @@ typedef HEAP* PHEAP;
 	} while(0)
 #define FPF_ERR(fmt, ...)	(fprintf(stderr, (fmt), ## __VA_ARGS__))
 
-vertice busca_vertice(const char* tail, const char* head,
-		lista vertices, vertice* vdst);
-void check_head_tail(const char* vname, vertice* head, vertice* tail);
+UINT hash_nome(const char* s);
+void insere_indice(grafo g, vertice v);
+void destroi_indice(grafo g);
+void constroi_adjacencia(grafo g);
+void destroi_adjacencia(grafo g);
+static int adjacentes_indice(const struct adjacencia* ad, UINT u, UINT w);
 int busca_aresta(lista l, aresta a);
-int destroi_vertice(void* c);
-int destroi_aresta(void* c);
 void* mymalloc(size_t size);
+void* myrealloc(void* p, size_t size);
+void* aloca_arena(struct arena* a, size_t tam);
+char* strdup_arena(struct arena* a, const char* s);
+void reserva_arena(struct arena* a, size_t tam);
+void libera_arena(struct arena* a);
+lista constroi_lista_arena(struct arena* a);
+grafo novo_grafo(const char* nome, int tipo);
+vertice novo_vertice(grafo g, const char* nome);
+aresta nova_aresta(grafo g, vertice tail, vertice head, LINT peso, bool ponderada);
+static grafo le_grafo_dot(const char* buf, size_t tam, size_t* usado);
+static bool le_entrada(FILE* input, struct entrada* e);
+static bool le_entrada_grafo(FILE* input, struct entrada* e);
+static size_t varre_dot(const char* p, size_t tam, bool parcial, struct varredura_dot* s);
+static void libera_entrada(struct entrada* e);
+static grafo le_grafo_memoria(const char* buf, size_t tam, bool terminado, size_t* usado);
+static size_t fim_grafo_dot(const char* p, size_t tam);
+static grafo le_grafo_cgraph(Agraph_t* Ag_g);
 static void BuildListOfEdges(grafo g, Agraph_t* Ag_g, Agnode_t* Ag_v, const char* head_name);
 static void BuildListOfArrows(grafo g, Agraph_t* Ag_g, Agnode_t* Ag_v, const char* head_name);
 typedef void (*BuildList)(grafo, Agraph_t*, Agnode_t*, const char*);
-void heapify(PHEAP heap);
-void heap_sort(PHEAP heap, int i);
-vertice heap_pop(PHEAP heap);
-void heap_push(PHEAP heap, vertice data);
-int lbl_ge(int *x, int *y);
-int lbl_g(int *x, int *y);
-void heap_free(PHEAP heap);
-PHEAP heap_alloc(int elem);
-void set_none_vertexes(grafo g);
-vertice nxt_neighbor_r(lista l);
-void set_none_arestas(grafo g);
-int are_neighbors(vertice v1, vertice v2);
-void xor(lista c);
-lista caminho_aumentante(grafo g);
-bool get_path(vertice v, lista path);
+int are_neighbors(grafo g, vertice v1, vertice v2);
+bool camadas(grafo g, struct emparelhamento* h);
+UINT caminho_aumentante(grafo g, struct emparelhamento* h);
+bool get_path(grafo g, UINT u, struct emparelhamento* h);
+void fases_paralelas(grafo g, struct emparelhamento* h, UINT n_threads, bool deterministico);
+void hopcroft_karp(grafo g, UINT n_threads, bool deterministico);
+void garante_csr(grafo g);
+static UINT* area_consulta(grafo g, consulta q, size_t tam);
+static void registra_auxiliar(grafo g, size_t tam);
+void constroi_csr(grafo g);
+void destroi_csr(grafo g);
+static void lista_da_csr(grafo g, const struct csr* c, UINT v, lista l);
+ESTAT(static unsigned long relogio_ns(void);)
 
 
 
@@ -177,6 +310,8 @@ no primeiro_no(lista l) { return l->primeiro; }
 
 void *conteudo(no n) { return n->conteudo; }
 
+static void libera_no(lista l, no n);
+
 //---------------------------------------------------------------------------
 // devolve o sucessor do nó n,
 //      ou NULL, se n for o último nó da lista
@@ -194,9 +329,12 @@ lista constroi_lista(void) {
 
   if ( ! l )
     return NULL;
+  CONTA(e_alocacoes, 1);
+  CONTA(e_bytes_alocados, sizeof(struct lista));
 
   l->primeiro = NULL;
   l->tamanho = 0;
+  l->arena = NULL;
 
   return l;
 }
@@ -224,10 +362,13 @@ int destroi_lista(lista l, int destroi(void *)) {
 	    if ( destroi )
 	      ok &= destroi(conteudo(p));
 
-	    free(p);
+	    if ( !l->arena )
+	      free(p);
 	  }
 
-	  free(l);
+	  // uma lista da arena (e seus nós) é liberada com a arena.
+	  if ( !l->arena )
+	    free(l);
 
 	  return ok;
 }
@@ -240,7 +381,18 @@ int destroi_lista(lista l, int destroi(void *)) {
 
 no insere_lista(void *conteudo, lista l) {
 
-  no novo = malloc(sizeof(struct no));
+  no novo;
+
+  if ( l->arena && l->arena->a_nos ) {
+    novo = l->arena->a_nos;
+    l->arena->a_nos = novo->proximo;
+  }
+  else if ( l->arena )
+    novo = aloca_arena(l->arena, sizeof(struct no));
+  else if ( (novo = malloc(sizeof(struct no))) ) {
+    CONTA(e_alocacoes, 1);
+    CONTA(e_bytes_alocados, sizeof(struct no));
+  }
 
   if ( ! novo )
 	return NULL;
@@ -266,17 +418,17 @@ int remove_no(struct lista *l, struct no *rno, int destroi(void *)) {
 		if (destroi != NULL) {
 			r = destroi(conteudo(rno));
 		}
-		free(rno);
+		libera_no(l, rno);
 		l->tamanho--;
 		return r;
 	}
-	for (no n = primeiro_no(l); n->proximo; n = proximo_no(n)) {
+	for (no n = primeiro_no(l); n && n->proximo; n = proximo_no(n)) {
 		if (n->proximo == rno) {
 			n->proximo = rno->proximo;
 			if (destroi != NULL) {
 				r = destroi(conteudo(rno));
 			}
-			free(rno);
+			libera_no(l, rno);
 			l->tamanho--;
 			return r;
 		}
@@ -284,9 +436,91 @@ int remove_no(struct lista *l, struct no *rno, int destroi(void *)) {
 	return 0;
 }
 
+//------------------------------------------------------------------------------
+// desaloca o nó n removido de l; um nó da arena fica para reúso.
+static void libera_no(lista l, no n) {
+	if (l->arena) {
+		n->proximo = l->arena->a_nos;
+		l->arena->a_nos = n;
+	} else
+		free(n);
+}
+
 /*
  * Aqui termina lista.c
  */
+
+//------------------------------------------------------------------------------
+// Torna corrente um bloco novo de pelo menos tam bytes na arena a.
+static void novo_bloco(struct arena* a, size_t tam) {
+	struct bloco*	b;
+	size_t			cap;
+
+	if( !a->a_proximo ) a->a_proximo = 1 << 16;
+	cap = tam > a->a_proximo ? tam : a->a_proximo;
+	if( a->a_proximo < (size_t)1 << 24 ) a->a_proximo *= 2;
+	b = (struct bloco*)mymalloc(sizeof(struct bloco) + cap);
+	CONTA(e_blocos_arena, 1);
+	b->b_tam = cap;
+	b->b_prox = a->a_blocos;
+	a->a_blocos = b;
+	a->a_livre = (char*)(b + 1);
+	a->a_resta = cap;
+}
+
+//------------------------------------------------------------------------------
+// Aloca tam bytes (alinhados em 8) da arena a.
+void* aloca_arena(struct arena* a, size_t tam) {
+	void*			p;
+
+	tam = (tam + 7) & ~(size_t)7;
+	if( tam > a->a_resta )
+		novo_bloco(a, tam);
+	p = a->a_livre;
+	a->a_livre += tam;
+	a->a_resta -= tam;
+
+	return p;
+}
+
+//------------------------------------------------------------------------------
+// Garante que as próximas alocações de até tam bytes (alinhamento incluído)
+// venham de um só bloco.
+void reserva_arena(struct arena* a, size_t tam) {
+	if( tam > a->a_resta )
+		novo_bloco(a, tam);
+}
+
+//------------------------------------------------------------------------------
+char* strdup_arena(struct arena* a, const char* s) {
+	size_t tam = strlen(s) + 1;
+
+	return memcpy(aloca_arena(a, tam), s, tam);
+}
+
+//------------------------------------------------------------------------------
+// Desaloca todos os blocos da arena a.
+void libera_arena(struct arena* a) {
+	struct bloco* b;
+
+	while( (b = a->a_blocos) ) {
+		a->a_blocos = b->b_prox;
+		free(b);
+	}
+	memset(a, 0, sizeof(struct arena));
+}
+
+//------------------------------------------------------------------------------
+// Cria uma lista vazia cujos nós vêm da arena a.
+lista constroi_lista_arena(struct arena* a) {
+	lista l = (lista)aloca_arena(a, sizeof(struct lista));
+
+	l->primeiro = NULL;
+	l->tamanho = 0;
+	l->arena = a;
+
+	return l;
+}
 //------------------------------------------------------------------------------
 char 	*nome_grafo(grafo g)		{ return g->g_nome; }
 char	*nome_vertice(vertice v)	{ return v->v_nome; }
@@ -296,39 +530,84 @@ UINT	n_vertices(grafo g)			{ return g->g_nvertices;   }
 UINT	n_arestas(grafo g)			{ return g->g_naresta; }
 
 //------------------------------------------------------------------------------
+// lê um grafo no formato dot de input
+//
+// o texto é lido (ou mapeado) de uma vez e interpretado pelo leitor próprio,
+// le_grafo_dot(); se ele usa construções que o leitor não trata, o grafo é
+// lido pela libcgraph a partir do mesmo texto.
 grafo le_grafo(FILE *input) {
-    Agraph_t*	Ag_g;
-    Agnode_t*	Ag_v;
-    grafo       g;
-    vertice		v;
+	struct entrada	e;
+	grafo			g;
+	size_t			usado;
 
-    g = (grafo)mymalloc(sizeof(struct grafo));
-	memset(g, 0, sizeof(struct grafo));
+	if( !le_entrada_grafo(input, &e) ) {
+		FPF_ERR("Could not read graph!\n");
+		return NULL;
+	}
 
-    Ag_g = agread(input, NULL);
-    if ( !Ag_g ) {
-    	free(g);
-    	FPF_ERR("Could not read graph!\n");
-        return NULL;
-    }
+	g = le_grafo_memoria(e.e_buf, e.e_tam, !e.e_mapa, &usado);
+	if( e.e_mapa ) fseeko(input, e.e_pos + (off_t)usado, SEEK_SET);
+	libera_entrada(&e);
+	return g;
+}
+
+//------------------------------------------------------------------------------
+// Lê um grafo do texto buf[0..tam) pelo leitor próprio ou, se ele não aceitar
+// o texto, pela libcgraph. A libcgraph não é reentrante e por isso só é usada
+// sob trava_cgraph. terminado indica que buf[tam] == '\0'.
+//
+// *usado recebe o número de bytes consumidos. A libcgraph só lê o primeiro
+// grafo do texto; por isso ela recebe só o texto dele, delimitado por
+// fim_grafo_dot(), e o resto fica para as leituras seguintes.
+static grafo le_grafo_memoria(const char* buf, size_t tam, bool terminado, size_t* usado) {
+	Agraph_t*	Ag_g;
+	grafo		g;
+	char*		txt = NULL;
+	INICIO(t0);
+
+	if( (g = le_grafo_dot(buf, tam, usado)) != NULL ) {
+		FIM(e_ns_leitura, t0);
+		return g;
+	}
+
+	*usado = fim_grafo_dot(buf, tam);
+	if( *usado && *usado < tam ) {
+		tam = *usado;
+		terminado = FALSE;
+	} else
+		*usado = tam;
+	// agmemread() precisa de texto terminado em '\0'.
+	if( !terminado ) {
+		txt = (char*)mymalloc(tam + 1);
+		memcpy(txt, buf, tam);
+		txt[tam] = '\0';
+	}
+	pthread_mutex_lock(&trava_cgraph);
+	Ag_g = agmemread(txt ? txt : buf);
+	if( Ag_g ) {
+		g = le_grafo_cgraph(Ag_g);
+		agclose(Ag_g);
+	}
+	pthread_mutex_unlock(&trava_cgraph);
+	free(txt);
+	if ( !g )
+		FPF_ERR("Could not read graph!\n");
+	FIM(e_ns_leitura, t0);
+
+	return g;
+}
+
+//------------------------------------------------------------------------------
+// Copia para um grafo o grafo Ag_g lido pela libcgraph.
+static grafo le_grafo_cgraph(Agraph_t* Ag_g) {
+    Agnode_t*	Ag_v;
+    grafo       g;
 
-    g->g_nome = strdup(agnameof(Ag_g));
-    g->g_tipo = agisdirected(Ag_g);
+    g = novo_grafo(agnameof(Ag_g), agisdirected(Ag_g));
     g->g_nvertices= (UINT)agnnodes(Ag_g);
     g->g_naresta = (UINT)agnedges(Ag_g);
-    g->g_vertices = constroi_lista();
-    for( Ag_v=agfstnode(Ag_g); Ag_v; Ag_v=agnxtnode(Ag_g, Ag_v) ) {
-    	/* construct data for the actual vertex */
-        v = (vertice)mymalloc(sizeof(struct vertice));
-        memset(v, 0, sizeof(struct vertice));
-        v->v_nome = strdup(agnameof(Ag_v));
-        v->v_lbl  = (int*)mymalloc(sizeof(int) * g->g_nvertices);
-		memset(v->v_lbl, 0, sizeof(int) * g->g_nvertices);
-        v->v_neighborhood_in = constroi_lista();
-        v->v_neighborhood_out = constroi_lista();
-        // Insert vertex to the list of vertexes in the graph list.
-        if( !insere_lista(v, g->g_vertices) ) exit(EXIT_FAILURE);
-    }
+    for( Ag_v=agfstnode(Ag_g); Ag_v; Ag_v=agnxtnode(Ag_g, Ag_v) )
+    	novo_vertice(g, agnameof(Ag_v));
 
     /* get all edges; neighborhood of all vertexes */
     BuildList build_list[2];
@@ -337,336 +616,1483 @@ grafo le_grafo(FILE *input) {
     for( Ag_v=agfstnode(Ag_g); Ag_v; Ag_v=agnxtnode(Ag_g, Ag_v) )
     	build_list[g->g_tipo](g, Ag_g, Ag_v, agnameof(Ag_v));
 
-    agclose(Ag_g);
+    constroi_csr(g);
     return g;
 }
 
 //------------------------------------------------------------------------------
-// Encontra caminho.
-bool get_path(vertice v, lista path) {
-	no		n;
-	aresta	a;
-	vertice	aux;
+// Mapeia o restante de input, se ele é um arquivo regular; quem usa o texto
+// mapeado posiciona input depois do que consumiu.
+//
+// devolve 1 se input foi mapeado ou
+//         0 caso contrário (e *e fica vazia)
+static bool mapeia_entrada(FILE* input, struct entrada* e) {
+	struct stat	st;
+	int			fd = fileno(input);
+	off_t		pos;
+	void*		m;
+
+	memset(e, 0, sizeof(struct entrada));
+	if( fd >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+		(pos = ftello(input)) >= 0 && st.st_size > pos ) {
+		m = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if( m != MAP_FAILED ) {
+			e->e_mapa = m;
+			e->e_tam_mapa = (size_t)st.st_size;
+			e->e_pos = pos;
+			e->e_buf = (char*)m + pos;
+			e->e_tam = (size_t)(st.st_size - pos);
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+//------------------------------------------------------------------------------
+// Mapeia (arquivo regular) ou lê (pipe, terminal, ...) o restante de input.
+//
+// devolve 1 em caso de sucesso ou
+//         0 caso contrário
+static bool le_entrada(FILE* input, struct entrada* e) {
+	size_t		cap, n, k;
 
-	if (!v->v_covered && !v->v_visitado) {
+	if( mapeia_entrada(input, e) )
 		return TRUE;
-	}
 
-	v->v_visitado = eVisited;
-	for( n=primeiro_no(v->v_neighborhood_out); n; n=proximo_no(n)) {
-		a = (aresta)conteudo(n);
-		aux= a->a_orig == v ? a->a_dst: a->a_orig;
-		if( aux->v_visitado == eNotSet ) {
-			if( get_path(aux, path)) {
-				insere_lista(a, path);
-				return TRUE;
-			}
+	cap = 1 << 16;
+	n = 0;
+	e->e_buf = (char*)mymalloc(cap);
+	while( (k = fread(e->e_buf + n, 1, cap - n - 1, input)) > 0 ) {
+		n += k;
+		if( n + 1 == cap ) {
+			cap *= 2;
+			e->e_buf = (char*)myrealloc(e->e_buf, cap);
 		}
 	}
+	e->e_buf[n] = '\0';
+	e->e_tam = n;
 
-	return FALSE;
+	return !ferror(input);
 }
 
 //------------------------------------------------------------------------------
-// Retorna uma lista do caminho aumentate, null caso contrário.
-lista caminho_aumentante(grafo g) {
-	lista 	path;
-	vertice	v;
-	no		n;
+// Como le_entrada(), mas de input que não pode ser mapeado lê só o texto de
+// um grafo, até a chave que fecha seu corpo; o resto fica em input para as
+// leituras seguintes.
+static bool le_entrada_grafo(FILE* input, struct entrada* e) {
+	struct varredura_dot	s = { 0, 0, FALSE };
+	size_t	cap = 1 << 12, n = 0;
+	int		c;
+
+	if( mapeia_entrada(input, e) )
+		return TRUE;
 
-	for( n = primeiro_no(g->g_vertices); n; n = proximo_no(n)) {
-		v = (vertice)conteudo(n);
-		if( !v->v_visitado && !v->v_covered ) {
-			path = constroi_lista();
-			v->v_visitado = eVisited;
-			if( get_path(v, path) ) {
-				return path;
-			}
-			destroi_lista(path, NULL);
+	e->e_buf = (char*)mymalloc(cap);
+	flockfile(input);
+	while( (c = getc_unlocked(input)) != EOF ) {
+		if( n + 1 == cap ) {
+			cap *= 2;
+			e->e_buf = (char*)myrealloc(e->e_buf, cap);
 		}
+		e->e_buf[n++] = (char)c;
+		// o corpo só pode terminar numa chave.
+		if( c == '}' && varre_dot(e->e_buf, n, TRUE, &s) )
+			break;
 	}
-	set_none_vertexes(g);
+	funlockfile(input);
+	e->e_buf[n] = '\0';
+	e->e_tam = n;
 
-	return NULL;
+	return !ferror(input);
 }
 
 //------------------------------------------------------------------------------
-// Se M é um emparelhamento em um grafo G e P é um caminho M-aumentante, então
-// o conjunto M xor E(P) é um emparelhamento em G  com |M|+1 arestas.
-// Teorema e dicas do monitor.
-void xor(lista path) {
-	aresta edge;
+static void libera_entrada(struct entrada* e) {
+	if( e->e_mapa )
+		munmap(e->e_mapa, e->e_tam_mapa);
+	else
+		free(e->e_buf);
+	memset(e, 0, sizeof(struct entrada));
+}
 
-	for (no a = primeiro_no(path); a; a = proximo_no(a)) {
-		edge = conteudo(a);
-		edge->a_covered = !edge->a_covered;
-		edge->a_orig->v_covered = 1;
-		edge->a_dst->v_covered = 1;
+//------------------------------------------------------------------------------
+// Conta, na lista de vizinhança l do vértice v, as posições que v terá na CSR.
+// Num grafo não direcionado um laço aparece duas vezes seguidas na lista de
+// v; na CSR ele ocupa uma única posição.
+static UINT conta_vizinhos_csr(lista l) {
+	UINT	count = 0;
+	void*	ant = NULL;
+
+	for( no n=primeiro_no(l); n; n=proximo_no(n) ) {
+		if( conteudo(n) == ant ) continue;
+		ant = conteudo(n);
+		++count;
 	}
+
+	return count;
 }
 
 //------------------------------------------------------------------------------
-// devolve um grafo cujos vertices são cópias de vértices do grafo
-// bipartido g e cujas arestas formam um emparelhamento máximo em g
-//
-// o grafo devolvido, portanto, é vazio ou tem todos os vértices com grau 1
-//
-// não verifica se g é bipartido; caso não seja, o comportamento é indefinido
-grafo emparelhamento_maximo(grafo g) {
-	lista 	path;
-	grafo 	empar;
-	vertice	v;
+// Preenche a CSR c a partir das listas de vizinhança (de entrada, se in != 0)
+// dos vértices de g, mantendo a ordem das listas.
+static void preenche_csr(grafo g, struct csr* c, bool in) {
+	UINT	i, k;
+	UINT	*inicio, *viz, *ar;
+	LINT*	peso;
 	aresta	a;
-	no		n,na;
+	vertice	v;
+	lista	l;
+	void*	ant;
+
+	inicio = (UINT*)mymalloc(sizeof(UINT) * (g->g_nvertices + 1));
+	inicio[0] = 0;
+	for( i = 0; i < g->g_nvertices; ++i ) {
+		v = g->g_v[i];
+		l = in ? v->v_neighborhood_in : v->v_neighborhood_out;
+		inicio[i+1] = inicio[i] + conta_vizinhos_csr(l);
+	}
 
-	while( (path = caminho_aumentante(g)) != NULL ) {
-		xor(path);
-		destroi_lista(path, NULL);
+	k = inicio[g->g_nvertices];
+	viz  = (UINT*)mymalloc(sizeof(UINT) * (k ? k : 1));
+	ar   = (UINT*)mymalloc(sizeof(UINT) * (k ? k : 1));
+	peso = (LINT*)mymalloc(sizeof(LINT) * (k ? k : 1));
+	for( i = 0, k = 0; i < g->g_nvertices; ++i ) {
+		v = g->g_v[i];
+		l = in ? v->v_neighborhood_in : v->v_neighborhood_out;
+		ant = NULL;
+		for( no n=primeiro_no(l); n; n=proximo_no(n) ) {
+			if( conteudo(n) == ant ) continue;
+			ant = conteudo(n);
+			a = (aresta)ant;
+			viz[k]  = (a->a_orig == v ? a->a_dst : a->a_orig)->v_id;
+			ar[k]   = a->a_id;
+			peso[k] = a->a_peso;
+			++k;
+		}
 	}
+	c->c_inicio = inicio;
+	c->c_viz = viz;
+	c->c_aresta = ar;
+	c->c_peso = peso;
+}
+
+//------------------------------------------------------------------------------
+// Desaloca um vetor de uma CSR construída por preenche_csr() ou copia_csr()
+// (os vetores são const em struct csr por causa da CSR mapeada).
+static void libera_vetor_csr(const void* p) {
+	free((void*)(uintptr_t)p);
+}
+
+//------------------------------------------------------------------------------
+// Constrói a representação compactada (CSR) de g a partir das listas.
+//
+// Os vértices são numerados na ordem de g_vertices e as arestas na ordem em
+// que aparecem nas vizinhanças (de saída) de sua origem. Todos os algoritmos
+// percorrem a CSR; as listas são mantidas para vizinhanca().
+void constroi_csr(grafo g) {
+	UINT	i, m;
+	vertice	v;
+	aresta	a;
+	no		n;
+	void*	ant;
 
-    empar = (grafo)mymalloc(sizeof(struct grafo));
-	memset(empar, 0, sizeof(struct grafo));
-    empar->g_nome = strdup(g->g_nome);
-    empar->g_vertices = constroi_lista();
+	g->g_nvertices = tamanho_lista(g->g_vertices);
+	g->g_v = (vertice*)mymalloc(sizeof(vertice) * (g->g_nvertices ? g->g_nvertices : 1));
+	i = 0;
 	for( n=primeiro_no(g->g_vertices); n; n=proximo_no(n) ) {
 		v = (vertice)conteudo(n);
+		v->v_id = i;
+		g->g_v[i++] = v;
+	}
 
-		vertice newv = (vertice)mymalloc(sizeof(struct vertice));
-		memset(newv, 0, sizeof(struct vertice));
-		newv->v_nome = strdup(v->v_nome);
-		newv->v_neighborhood_in  = constroi_lista();
-		newv->v_neighborhood_out = constroi_lista();
-		insere_lista(newv, empar->g_vertices);
-		empar->g_nvertices++;
+	m = 0;
+	for( i = 0; i < g->g_nvertices; ++i )
+		m += conta_vizinhos_csr(g->g_v[i]->v_neighborhood_out);
+	// num grafo não direcionado cada aresta (exceto laços) aparece duas vezes.
+	g->g_a = (aresta*)mymalloc(sizeof(aresta) * (m ? m : 1));
+	m = 0;
+	for( i = 0; i < g->g_nvertices; ++i ) {
+		v = g->g_v[i];
+		ant = NULL;
+		for( n=primeiro_no(v->v_neighborhood_out); n; n=proximo_no(n) ) {
+			a = (aresta)conteudo(n);
+			if( a == ant || a->a_orig != v ) continue;
+			ant = a;
+			a->a_id = m;
+			g->g_a[m++] = a;
+		}
 	}
+	g->g_naresta = m;
 
-	for( n=primeiro_no(g->g_vertices); n; n=proximo_no(n) ) {
-		v = (vertice)conteudo(n);
-		for( na = primeiro_no(v->v_neighborhood_out); na; na = proximo_no(na) ) {
-			a = (aresta)conteudo(na);
-			if( a->a_orig == v && a->a_covered ) {
-				aresta newe;
-
-				newe = (aresta)malloc(sizeof(struct aresta));
-				memset(newe, 0, sizeof(struct aresta));
-
-				newe->a_orig = busca_vertice(a->a_orig->v_nome,\
-						a->a_dst->v_nome, empar->g_vertices, &newe->a_dst);
-				insere_lista(newe, newe->a_orig->v_neighborhood_out);
-				insere_lista(newe, newe->a_dst->v_neighborhood_out);
-				g->g_nvertices++;
+	preenche_csr(g, &g->g_out, FALSE);
+	if( g->g_tipo )
+		preenche_csr(g, &g->g_in, TRUE);
+}
+
+//------------------------------------------------------------------------------
+// Desaloca a CSR de g (e o índice de adjacência, que depende dela).
+void destroi_csr(grafo g) {
+	struct csr* c[2] = { &g->g_out, &g->g_in };
+
+	// a CSR de um snapshot binário está no mapeamento.
+	for( int i = 0; i < 2; ++i ) {
+		if( !g->g_csr_mapeada ) {
+			libera_vetor_csr(c[i]->c_inicio);
+			libera_vetor_csr(c[i]->c_viz);
+			libera_vetor_csr(c[i]->c_aresta);
+			libera_vetor_csr(c[i]->c_peso);
+		}
+		memset(c[i], 0, sizeof(struct csr));
+	}
+	free(g->g_v);
+	free(g->g_a);
+	g->g_v = NULL;
+	g->g_a = NULL;
+	g->g_csr_mapeada = FALSE;
+	destroi_adjacencia(g);
+}
+
+//------------------------------------------------------------------------------
+// Encontra, a partir do vértice livre u da esquerda, um caminho aumentante
+// mínimo na floresta de camadas da fase corrente e inverte o emparelhamento
+// ao longo dele.
+//
+// A busca em profundidade usa a pilha h->pilha (os vértices da esquerda do
+// caminho corrente) em vez de recursão. h->cursor[v] guarda a posição da
+// vizinhança de v sendo examinada, de forma que cada aresta é examinada no
+// máximo uma vez por fase, mesmo depois de retrocessos.
+bool get_path(grafo g, UINT u, struct emparelhamento* h) {
+	UINT	topo = 0, k, w, x;
+	ESTAT(UINT visitas = 1, passos = 0;)
+
+	h->pilha[topo++] = u;
+	while( topo ) {
+		u = h->pilha[topo-1];
+		k = h->cursor[u];
+		if( k == g->g_out.c_inicio[u+1] ) {
+			// u não leva a um vértice livre nesta fase.
+			h->dist[u] = NENHUM;
+			if( --topo )
+				++h->cursor[h->pilha[topo-1]];
+			continue;
+		}
+		ESTAT(++passos;)
+		w = g->g_out.c_viz[k];
+		x = h->par[w];
+		if( x == NENHUM && h->dist[u] + 1 == h->limite ) {
+			CONTA(e_vertices_visitados, visitas);
+			CONTA(e_arestas_examinadas, passos);
+			// inverte o caminho: cada vértice da pilha fica com o vizinho
+			// apontado por seu cursor.
+			while( topo-- ) {
+				u = h->pilha[topo];
+				k = h->cursor[u];
+				w = g->g_out.c_viz[k];
+				h->par[u] = w;
+				h->par[w] = u;
+				h->aresta[u] = h->aresta[w] = g->g_out.c_aresta[k];
 			}
+			return TRUE;
 		}
+		if( x != NENHUM && h->dist[x] == h->dist[u] + 1 ) {
+			h->pilha[topo++] = x;
+			ESTAT(++visitas;)
+		} else
+			++h->cursor[u];
 	}
+	CONTA(e_vertices_visitados, visitas);
+	CONTA(e_arestas_examinadas, passos);
 
-	return empar;
+	return FALSE;
 }
 
-
 //------------------------------------------------------------------------------
-// devolve uma lista de vertices com a ordem dos vértices dada por uma 
-// busca em largura lexicográfica
+// Busca em largura a partir dos vértices livres da esquerda, separando-os em
+// camadas (h->dist) até a primeira camada que alcança um vértice livre da
+// direita (h->limite).
 //
-// A função faz uso da heap para implementar com uma performace umm pouco maior.
-lista busca_largura_lexicografica(grafo g) {
-	no 		na;
-	vertice v, aux;
-	aresta	a;
-	int 	current_lbl, i;
-	lista 	perf_seq;
-	PHEAP 	heap;
+// devolve 0 se não há caminho aumentante.
+bool camadas(grafo g, struct emparelhamento* h) {
+	UINT	ini, fim, u, w, x, k, n = g->g_nvertices;
+
+	ini = fim = 0;
+	for( u = 0; u < n; ++u ) {
+		if( !h->lado[u] && h->par[u] == NENHUM ) {
+			h->dist[u] = 0;
+			h->fila[fim++] = u;
+		} else
+			h->dist[u] = NENHUM;
+		h->cursor[u] = g->g_out.c_inicio[u];
+	}
 
-	perf_seq = constroi_lista();
-	heap = heap_alloc((int)g->g_nvertices);
-	heap_push(heap, conteudo(primeiro_no(g->g_vertices)));
-	current_lbl = (int)g->g_nvertices;
-	while( (v = heap_pop(heap)) != NULL ) {
-		if( v->v_visitado == eInserted ) continue; // Se já inserido na lista perfeita, va para p prox.
-		v->v_visitado = eInserted; // Marque como inserido.
-		insere_lista(v, perf_seq);
-		for( na = primeiro_no(v->v_neighborhood_out); na; na = proximo_no(na) ) {
-			a = conteudo(na);
-			if( !a->a_visitada ) {
-				aux = a->a_orig == v ? a->a_dst : a->a_orig;
-				if( aux->v_visitado != eInserted ) {
-					i = 0;
-					while( *(aux->v_lbl+i++) );
-					*(aux->v_lbl+i) = current_lbl;
-				}
-				// Se chegou aqui é porque não esta nem na lista perfeira nem na heap.
-				if( !aux->v_visitado ) {
-					heap_push(heap, aux);
-					// aqui indica que foi inserido na heap.
-					aux->v_visitado = eVisited;
-				}
-				a->a_visitada = eVisited;
+	h->limite = NENHUM;
+	ESTAT(UINT passos = 0;)
+	while( ini < fim ) {
+		u = h->fila[ini++];
+		if( h->dist[u] + 1 >= h->limite ) break;
+		ESTAT(passos += g->g_out.c_inicio[u+1] - g->g_out.c_inicio[u];)
+		for( k = g->g_out.c_inicio[u]; k < g->g_out.c_inicio[u+1]; ++k ) {
+			w = g->g_out.c_viz[k];
+			x = h->par[w];
+			if( x == NENHUM )
+				h->limite = h->dist[u] + 1;
+			else if( h->dist[x] == NENHUM ) {
+				h->dist[x] = h->dist[u] + 1;
+				h->fila[fim++] = x;
 			}
 		}
-		heapify(heap);
-		--current_lbl;
 	}
+	CONTA(e_fases, h->limite != NENHUM);
+	CONTA(e_vertices_visitados, ini);
+	CONTA(e_arestas_examinadas, passos);
 
-	set_none_vertexes(g);
-	set_none_arestas(g);
-	heap_free(heap);
+	return h->limite != NENHUM;
+}
 
-	return perf_seq;
+//------------------------------------------------------------------------------
+// Uma fase de Hopcroft-Karp: camadas() seguida de buscas em profundidade que
+// encontram um conjunto maximal de caminhos aumentantes mínimos disjuntos.
+//
+// devolve o número de caminhos aumentantes encontrados.
+UINT caminho_aumentante(grafo g, struct emparelhamento* h) {
+	UINT	u, n = g->g_nvertices, count = 0;
+
+	if( !camadas(g, h) ) return 0;
 
+	for( u = 0; u < n; ++u )
+		if( !h->lado[u] && h->par[u] == NENHUM && get_path(g, u, h) )
+			++count;
+	CONTA(e_caminhos, count);
+
+	return count;
 }
 
 //------------------------------------------------------------------------------
-// Seta para não visitados as arestas do grafo G.
-void set_none_arestas(grafo g) {
-	for (no nv = primeiro_no(g->g_vertices); nv; nv = proximo_no(nv)) {
-		vertice v = conteudo(nv);
-		for (no na = primeiro_no(v->v_neighborhood_out); na; na = proximo_no(na))
-		((aresta)conteudo(na))->a_visitada = eNotSet;
+// Separa os vértices de g (bipartido) em esquerda (lado 0) e direita
+// (lado 1) por busca em largura.
+static void biparticao(grafo g, struct emparelhamento* h) {
+	UINT	ini, fim, s, u, k, n = g->g_nvertices;
+
+	memset(h->lado, 0xff, n);
+	for( s = 0; s < n; ++s ) {
+		if( h->lado[s] != 0xff ) continue;
+		h->lado[s] = 0;
+		ini = fim = 0;
+		h->fila[fim++] = s;
+		while( ini < fim ) {
+			u = h->fila[ini++];
+			for( k = g->g_out.c_inicio[u]; k < g->g_out.c_inicio[u+1]; ++k ) {
+				if( h->lado[g->g_out.c_viz[k]] != 0xff ) continue;
+				h->lado[g->g_out.c_viz[k]] = !h->lado[u];
+				h->fila[fim++] = g->g_out.c_viz[k];
+			}
+		}
 	}
 }
 
 //------------------------------------------------------------------------------
-// Seta para não visitados os vertices do grafo G.
-void set_none_vertexes(grafo g) {
-	for (no nv = primeiro_no(g->g_vertices); nv; nv = proximo_no(nv))
-		((vertice)conteudo(nv))->v_visitado = eNotSet;
+// Emparelha u e w pela aresta da posição k da CSR e atualiza o grau (entre
+// vértices livres) dos vizinhos de ambos, enfileirando os que ficam com
+// grau 1.
+static void emparelha_ks(grafo g, struct emparelhamento* h, UINT u, UINT w, UINT k, UINT* fim) {
+	UINT	v, j, x;
+
+	h->par[u] = w;
+	h->par[w] = u;
+	h->aresta[u] = h->aresta[w] = g->g_out.c_aresta[k];
+	for( v = u, j = 0; j < 2; v = w, ++j ) {
+		for( k = g->g_out.c_inicio[v]; k < g->g_out.c_inicio[v+1]; ++k ) {
+			x = g->g_out.c_viz[k];
+			if( h->par[x] == NENHUM && --h->dist[x] == 1 )
+				h->fila[(*fim)++] = x;
+		}
+	}
 }
 
 //------------------------------------------------------------------------------
-// devolve 1, se a lista l representa uma 
-//            ordem perfeita de eliminação para o grafo g ou
-//         0, caso contrário
+// Emparelhamento inicial de Karp-Sipser, em tempo O(|V|+|E|): enquanto houver
+// vértice livre de grau 1 (contando só vizinhos livres) ele é emparelhado com
+// seu único vizinho livre, o que nunca impede um emparelhamento máximo; senão
+// um vértice livre qualquer é emparelhado com um vizinho livre.
 //
-// o tempo de execução é O(|V(G)|+|E(G)|)
-int ordem_perfeita_eliminacao(lista l, grafo g) {
-	lista* 	neighbors_r, l2;
-	UINT 	i, count;
-	no		nv, ne, n2, n3;
-	aresta	e;
-	vertice	v, v2, aux, tmp;
-
-	neighbors_r = (lista*)mymalloc(sizeof(lista) * (size_t) g->g_nvertices);
-	for( i = 0; i < g->g_nvertices; ++i )
-		*(neighbors_r+i) = constroi_lista();
+// Usa h->dist como grau e h->fila como fila dos vértices de grau 1.
+static void karp_sipser(grafo g, struct emparelhamento* h) {
+	UINT	n = g->g_nvertices, ini = 0, fim = 0, prox = 0, u, k;
+	ESTAT(UINT pares = 0;)
+
+	for( u = 0; u < n; ++u ) {
+		h->dist[u] = g->g_out.c_inicio[u+1] - g->g_out.c_inicio[u];
+		if( h->dist[u] == 1 )
+			h->fila[fim++] = u;
+	}
 
-	count = 0;
-	for( nv=primeiro_no(l); nv; nv=proximo_no(nv) ) {
-		v = (vertice)conteudo(nv);
-		v->v_visitado = eVisited;
-		v->v_index = (int)count;
-		for( ne=primeiro_no(v->v_neighborhood_out); ne; ne=proximo_no(ne) ) {
-			e = (aresta)conteudo(ne);
-			aux = e->a_orig == v ? e->a_dst : e->a_orig;
-			if( aux->v_visitado ) continue;
-			// insere na lista somente os vizinhos que estão à direita da lista
-			insere_lista(aux, *(neighbors_r+count));
+	for( ;; ) {
+		if( ini < fim )
+			u = h->fila[ini++];
+		else {
+			while( prox < n && (h->par[prox] != NENHUM || h->dist[prox] == 0) ) ++prox;
+			if( prox == n ) break;
+			u = prox;
 		}
-		++count;
+		if( h->par[u] != NENHUM ) continue;
+		for( k = g->g_out.c_inicio[u]; k < g->g_out.c_inicio[u+1]; ++k )
+			if( h->par[g->g_out.c_viz[k]] == NENHUM && g->g_out.c_viz[k] != u ) break;
+		if( k == g->g_out.c_inicio[u+1] ) {
+			h->dist[u] = 0;
+			continue;
+		}
+		emparelha_ks(g, h, u, g->g_out.c_viz[k], k, &fim);
+		ESTAT(++pares;)
 	}
-	set_none_vertexes(g);
+	CONTA(e_emparelhados_ks, pares);
+}
+
+/*________________________________________________________________*/
+/*
+ * Aqui comeca o emparelhamento paralelo.
+ *
+ * As fases de Hopcroft-Karp são divididas entre threads: a busca em largura
+ * (camadas) é feita pela thread principal e as buscas em profundidade a
+ * partir dos vértices livres da esquerda são feitas em paralelo, em blocos
+ * de EMP_BLOCO vértices distribuídos dinamicamente.
+ *
+ * No modo concorrente cada vértice é reivindicado atomicamente (dono[v])
+ * pela thread que o visita primeiro na fase, o que torna disjuntos os
+ * caminhos encontrados, e cada thread aumenta o emparelhamento ao encontrar
+ * um caminho.
+ *
+ * No modo determinístico as buscas só leem o emparelhamento do início da
+ * fase: cada bloco guarda os caminhos que encontrou (disjuntos entre si) e,
+ * ao final da fase, a thread principal aceita, na ordem dos blocos, cada
+ * caminho disjunto dos já aceitos. O resultado não depende do escalonamento
+ * nem do número de threads.
+ */
 
-	for( nv = primeiro_no(l); nv; nv = proximo_no(nv) ) {
-		v = conteudo(nv);
-		v2 = nxt_neighbor_r(*(neighbors_r+v->v_index));
-		if( !v2 ) continue;
+#define EMP_BLOCO	256u
 
-		l2 = *(neighbors_r+v2->v_index);
-		for( n2 = primeiro_no(neighbors_r[v->v_index]); n2; n2 = proximo_no(n2) ) {
-			tmp = conteudo(n2);
-			// tmp será todos os vizinhos à direita de v tirando)
-			if( tmp == v2 ) continue;
-			for( n3=primeiro_no(l2); n3; n3=proximo_no(n3) ) {
-				if( tmp == conteudo(n3) ) break;
-			}
-			if( !n3 ) {
-				// n3 == NULL quer dizer que esse vizinho à direita de v
-				// não é vizinho à direita de v2
-				for( i = 0; i < g->g_nvertices; ++i ) {
-					destroi_lista(*(neighbors_r+i), NULL);
+// caminhos encontrados por um bloco: (tamanho, u0, k0, u1, k1, ...) em que
+// ki é a posição da CSR da aresta de ui usada no caminho.
+struct caminhos_bloco {
+	UINT*	cb_buf;
+	UINT	cb_tam, cb_cap;
+};
+
+struct paralelo;
+
+struct trabalhador {
+	struct paralelo*	t_p;
+	UINT*		t_marca;		// selo do bloco que visitou v (determinístico).
+	UINT*		t_cursor;		// cursor local (determinístico).
+	UINT*		t_pilha;
+	UINT		t_selo;
+	UINT		padding;
+	pthread_t	t_thread;
+};
+
+struct paralelo {
+	grafo					p_g;
+	struct emparelhamento*	p_h;
+	struct trabalhador*		p_t;
+	struct caminhos_bloco*	p_blocos;
+	UINT*		p_livres;		// vértices livres da esquerda da fase.
+	UINT*		p_dono;			// fase em que v foi reivindicado/aceito.
+	UINT		p_nlivres;
+	UINT		p_nblocos, p_cap_blocos;
+	UINT		p_proximo;		// próximo bloco a processar (atômico).
+	UINT		p_fase;
+	UINT		p_encontrados;	// caminhos aumentados na fase (atômico).
+	UINT		p_nthreads;
+	bool		p_deterministico;
+	bool		p_fim;
+	UINT		padding;
+	pthread_barrier_t	p_barreira;
+};
+
+//------------------------------------------------------------------------------
+// Reivindica v para a fase corrente; devolve 1 se conseguiu.
+static bool reivindica(struct paralelo* p, UINT v) {
+	UINT antigo = __atomic_load_n(&p->p_dono[v], __ATOMIC_RELAXED);
+
+	return antigo != p->p_fase &&
+		__atomic_compare_exchange_n(&p->p_dono[v], &antigo, p->p_fase, FALSE,
+			__ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+// Busca concorrente a partir de u (ver get_path()), reivindicando cada
+// vértice visitado. Aumenta o emparelhamento se encontrar um caminho.
+static void busca_concorrente(struct trabalhador* t, UINT u) {
+	struct paralelo*		p = t->t_p;
+	struct emparelhamento*	h = p->p_h;
+	const struct csr*		c = &p->p_g->g_out;
+	UINT	topo = 0, k, w, x;
+	ESTAT(UINT visitas = 1, passos = 0;)
+
+	if( !reivindica(p, u) ) return;
+	h->cursor[u] = c->c_inicio[u];
+	t->t_pilha[topo++] = u;
+	while( topo ) {
+		u = t->t_pilha[topo-1];
+		k = h->cursor[u];
+		if( k == c->c_inicio[u+1] ) {
+			if( --topo )
+				++h->cursor[t->t_pilha[topo-1]];
+			continue;
+		}
+		ESTAT(++passos;)
+		w = c->c_viz[k];
+		x = __atomic_load_n(&h->par[w], __ATOMIC_ACQUIRE);
+		if( x == NENHUM ) {
+			if( h->dist[u] + 1 == h->limite && reivindica(p, w) ) {
+				CONTA(e_vertices_visitados, visitas);
+				CONTA(e_arestas_examinadas, passos);
+				while( topo-- ) {
+					u = t->t_pilha[topo];
+					k = h->cursor[u];
+					w = c->c_viz[k];
+					h->aresta[u] = h->aresta[w] = c->c_aresta[k];
+					__atomic_store_n(&h->par[u], w, __ATOMIC_RELEASE);
+					__atomic_store_n(&h->par[w], u, __ATOMIC_RELEASE);
 				}
-				free(neighbors_r);
-				return 0;
+				__atomic_add_fetch(&p->p_encontrados, 1, __ATOMIC_RELAXED);
+				return;
 			}
-		}
+			++h->cursor[u];
+		} else if( h->dist[x] == h->dist[u] + 1 && reivindica(p, x) ) {
+			h->cursor[x] = c->c_inicio[x];
+			t->t_pilha[topo++] = x;
+			ESTAT(++visitas;)
+		} else
+			++h->cursor[u];
 	}
+	CONTA(e_vertices_visitados, visitas);
+	CONTA(e_arestas_examinadas, passos);
+}
 
-	for( i = 0; i < g->g_nvertices; ++i ) {
-		destroi_lista(*(neighbors_r+i), NULL);
+//------------------------------------------------------------------------------
+// Busca determinística a partir de u: só lê o emparelhamento e marca os
+// vértices visitados com o selo do bloco; o caminho encontrado é guardado
+// em cb.
+static void busca_deterministica(struct trabalhador* t, UINT u, struct caminhos_bloco* cb) {
+	struct emparelhamento*	h = t->t_p->p_h;
+	const struct csr*		c = &t->t_p->p_g->g_out;
+	UINT	topo = 0, k, w, x, i;
+	ESTAT(UINT visitas = 1, passos = 0;)
+
+	if( t->t_marca[u] == t->t_selo ) return;
+	t->t_marca[u] = t->t_selo;
+	t->t_cursor[u] = c->c_inicio[u];
+	t->t_pilha[topo++] = u;
+	while( topo ) {
+		u = t->t_pilha[topo-1];
+		k = t->t_cursor[u];
+		if( k == c->c_inicio[u+1] ) {
+			if( --topo )
+				++t->t_cursor[t->t_pilha[topo-1]];
+			continue;
+		}
+		ESTAT(++passos;)
+		w = c->c_viz[k];
+		x = h->par[w];
+		if( x == NENHUM ) {
+			if( h->dist[u] + 1 == h->limite && t->t_marca[w] != t->t_selo ) {
+				CONTA(e_vertices_visitados, visitas);
+				CONTA(e_arestas_examinadas, passos);
+				t->t_marca[w] = t->t_selo;
+				if( cb->cb_tam + 2 * topo + 1 > cb->cb_cap ) {
+					cb->cb_cap = 2 * (cb->cb_tam + 2 * topo + 1);
+					cb->cb_buf = (UINT*)myrealloc(cb->cb_buf, sizeof(UINT) * cb->cb_cap);
+				}
+				cb->cb_buf[cb->cb_tam++] = topo;
+				for( i = 0; i < topo; ++i ) {
+					cb->cb_buf[cb->cb_tam++] = t->t_pilha[i];
+					cb->cb_buf[cb->cb_tam++] = t->t_cursor[t->t_pilha[i]];
+				}
+				return;
+			}
+			++t->t_cursor[u];
+		} else if( h->dist[x] == h->dist[u] + 1 && t->t_marca[x] != t->t_selo ) {
+			t->t_marca[x] = t->t_selo;
+			t->t_cursor[x] = c->c_inicio[x];
+			t->t_pilha[topo++] = x;
+			ESTAT(++visitas;)
+		} else
+			++t->t_cursor[u];
 	}
-	free(neighbors_r);
+	CONTA(e_vertices_visitados, visitas);
+	CONTA(e_arestas_examinadas, passos);
+}
 
-	return 1;
+//------------------------------------------------------------------------------
+// Processa blocos de vértices livres da fase corrente até acabarem.
+static void processa_blocos(struct trabalhador* t) {
+	struct paralelo*	p = t->t_p;
+	UINT	b, i, fim;
+
+	while( (b = __atomic_fetch_add(&p->p_proximo, 1, __ATOMIC_RELAXED)) < p->p_nblocos ) {
+		fim = (b + 1) * EMP_BLOCO < p->p_nlivres ? (b + 1) * EMP_BLOCO : p->p_nlivres;
+		if( p->p_deterministico ) {
+			if( ++t->t_selo == 0 ) {
+				memset(t->t_marca, 0, sizeof(UINT) * p->p_g->g_nvertices);
+				t->t_selo = 1;
+			}
+			p->p_blocos[b].cb_tam = 0;
+			for( i = b * EMP_BLOCO; i < fim; ++i )
+				busca_deterministica(t, p->p_livres[i], &p->p_blocos[b]);
+		} else
+			for( i = b * EMP_BLOCO; i < fim; ++i )
+				busca_concorrente(t, p->p_livres[i]);
+	}
 }
 
 //------------------------------------------------------------------------------
-grafo escreve_grafo(FILE *output, grafo g) {
-	vertice v;
-    aresta 	e;
-    char 	ch;
-    no		n, ne;
+// Laço das threads auxiliares: cada fase é delimitada por duas barreiras.
+static void* trabalha(void* arg) {
+	struct trabalhador*	t = (struct trabalhador*)arg;
+
+	for( ;; ) {
+		pthread_barrier_wait(&t->t_p->p_barreira);
+		if( t->t_p->p_fim ) break;
+		processa_blocos(t);
+		pthread_barrier_wait(&t->t_p->p_barreira);
+	}
 
-    if( !g ) return NULL;
-    fprintf( output, "strict %sgraph \"%s\" {\n\n",
-    		direcionado(g) ? "di" : "", g->g_nome
-    );
+	return NULL;
+}
+
+//------------------------------------------------------------------------------
+// Aceita, na ordem dos blocos, os caminhos disjuntos dos já aceitos.
+static void aceita_caminhos(struct paralelo* p) {
+	struct emparelhamento*	h = p->p_h;
+	const struct csr*		c = &p->p_g->g_out;
+	UINT	b, j, i, tam, u, w;
+	UINT*	q;
+
+	for( b = 0; b < p->p_nblocos; ++b ) {
+		for( j = 0; j < p->p_blocos[b].cb_tam; j += 2 * tam + 1 ) {
+			q = p->p_blocos[b].cb_buf + j;
+			tam = q[0];
+			w = c->c_viz[q[2 * tam]];
+			for( i = 0; i < tam && p->p_dono[q[2 * i + 1]] != p->p_fase; ++i );
+			if( i < tam || p->p_dono[w] == p->p_fase ) continue;
+			p->p_dono[w] = p->p_fase;
+			for( i = 0; i < tam; ++i ) {
+				u = q[2 * i + 1];
+				w = c->c_viz[q[2 * i + 2]];
+				p->p_dono[u] = p->p_fase;
+				h->par[u] = w;
+				h->par[w] = u;
+				h->aresta[u] = h->aresta[w] = c->c_aresta[q[2 * i + 2]];
+			}
+			p->p_encontrados++;
+		}
+	}
+}
 
-    for( n=primeiro_no(g->g_vertices); n; n=proximo_no(n) )
-        fprintf(output, "    \"%s\"\n", ((vertice)conteudo(n))->v_nome);
-    fprintf( output, "\n" );
+//------------------------------------------------------------------------------
+// Completa o emparelhamento h de g com fases paralelas em n_threads threads
+// (a principal inclusive). Uma fase concorrente que não aumenta o
+// emparelhamento, embora haja caminho aumentante, é refeita sequencialmente.
+void fases_paralelas(grafo g, struct emparelhamento* h, UINT n_threads, bool deterministico) {
+	struct paralelo	p;
+	UINT	n = g->g_nvertices, i;
+
+	memset(&p, 0, sizeof(struct paralelo));
+	p.p_g = g;
+	p.p_h = h;
+	p.p_nthreads = n_threads;
+	p.p_deterministico = deterministico;
+	p.p_livres = (UINT*)mymalloc(sizeof(UINT) * 2 * (n ? n : 1));
+	p.p_dono = p.p_livres + n;
+	memset(p.p_dono, 0, sizeof(UINT) * n);
+	p.p_t = (struct trabalhador*)mymalloc(sizeof(struct trabalhador) * n_threads);
+	memset(p.p_t, 0, sizeof(struct trabalhador) * n_threads);
+	pthread_barrier_init(&p.p_barreira, NULL, n_threads);
+	for( i = 0; i < n_threads; ++i ) {
+		p.p_t[i].t_p = &p;
+		p.p_t[i].t_pilha = (UINT*)mymalloc(sizeof(UINT) * 3 * (n ? n : 1));
+		p.p_t[i].t_marca = p.p_t[i].t_pilha + n;
+		p.p_t[i].t_cursor = p.p_t[i].t_marca + n;
+		memset(p.p_t[i].t_marca, 0, sizeof(UINT) * n);
+		if( i && pthread_create(&p.p_t[i].t_thread, NULL, trabalha, &p.p_t[i]) ) {
+			perror("Could not create thread!");
+			exit(EXIT_FAILURE);
+		}
+	}
 
-	ch = direcionado(g) ? '>' : '-';
-	for( n=primeiro_no(g->g_vertices); n; n=proximo_no(n) ) {
-		v = (vertice)conteudo(n);
-		for( ne=primeiro_no(v->v_neighborhood_out); ne; ne=proximo_no(ne) ) {
-			e = (aresta)conteudo(ne);
-			if( e->a_visitada == eVisited ) continue;
-			e->a_visitada = eVisited;
-			fprintf(output, "    \"%s\" -%c \"%s\"",
-				e->a_orig->v_nome, ch, e->a_dst->v_nome
-			);
-
-			if ( g->g_ponderado )
-				fprintf( output, " [peso=%ld]", e->a_peso );
-			fprintf( output, "\n" );
+	for( ;; ) {
+		if( !camadas(g, h) ) break;
+		p.p_nlivres = 0;
+		for( i = 0; i < n; ++i )
+			if( !h->lado[i] && h->par[i] == NENHUM )
+				p.p_livres[p.p_nlivres++] = i;
+		p.p_nblocos = (p.p_nlivres + EMP_BLOCO - 1) / EMP_BLOCO;
+		if( p.p_nblocos > p.p_cap_blocos ) {
+			p.p_blocos = (struct caminhos_bloco*)myrealloc(p.p_blocos, sizeof(struct caminhos_bloco) * p.p_nblocos);
+			memset(p.p_blocos + p.p_cap_blocos, 0, sizeof(struct caminhos_bloco) * (p.p_nblocos - p.p_cap_blocos));
+			p.p_cap_blocos = p.p_nblocos;
 		}
+		p.p_proximo = 0;
+		p.p_encontrados = 0;
+		p.p_fase++;
+
+		// a thread principal trabalha junto com as auxiliares.
+		pthread_barrier_wait(&p.p_barreira);
+		processa_blocos(&p.p_t[0]);
+		pthread_barrier_wait(&p.p_barreira);
+		if( deterministico )
+			aceita_caminhos(&p);
+		CONTA(e_caminhos, p.p_encontrados);
+		if( !p.p_encontrados && !caminho_aumentante(g, h) ) break;
 	}
-    fprintf( output, "}\n" );
 
-    set_none_arestas(g);
-    return g;
+	p.p_fim = TRUE;
+	pthread_barrier_wait(&p.p_barreira);
+	for( i = 1; i < n_threads; ++i )
+		pthread_join(p.p_t[i].t_thread, NULL);
+	pthread_barrier_destroy(&p.p_barreira);
+	for( i = 0; i < n_threads; ++i )
+		free(p.p_t[i].t_pilha);
+	for( i = 0; i < p.p_cap_blocos; ++i )
+		free(p.p_blocos[i].cb_buf);
+	free(p.p_blocos);
+	free(p.p_t);
+	free(p.p_livres);
 }
 
+/*
+ * Aqui termina o emparelhamento paralelo.
+ */
+
+
 //------------------------------------------------------------------------------
-// devolve 1, se o conjunto dos vertices em l é uma clique em g, ou
-//         0, caso contrário
-//
-// um conjunto C de vértices de um grafo é uma clique em g
-// se todo vértice em C é vizinho de todos os outros vértices de C em g
-int are_neighbors(vertice v1, vertice v2) {
-	aresta 	a;
-	no 		n;
-
-    for( n=primeiro_no(v1->v_neighborhood_out); n; n = proximo_no(n)) {
-        a = (aresta)conteudo(n);
-        if( (a->a_dst == v2 && a->a_orig == v1) ||\
-        	(a->a_dst == v1 && a->a_orig == v2)) {
-            return 1;
-        }
-    }
+// Calcula um emparelhamento máximo de g (Hopcroft-Karp, O(sqrt(V)·E)) e o
+// marca em a_covered/v_covered. As fases são paralelas se n_threads > 1 ou
+// se deterministico (ver fases_paralelas()).
+void hopcroft_karp(grafo g, UINT n_threads, bool deterministico) {
+	struct emparelhamento	h;
+	UINT	n = g->g_nvertices, i;
+	INICIO(t0);
+
+	h.par    = (UINT*)mymalloc(sizeof(UINT) * 6 * (n ? n : 1));
+	h.aresta = h.par + n;
+	h.dist   = h.aresta + n;
+	h.fila   = h.dist + n;
+	h.cursor = h.fila + n;
+	h.pilha  = h.cursor + n;
+	h.lado   = (unsigned char*)mymalloc(n ? n : 1);
+	for( i = 0; i < n; ++i )
+		h.par[i] = h.aresta[i] = NENHUM;
+	// as fases paralelas usam mais 2n UINTs e 3n por thread.
+	registra_auxiliar(g, (sizeof(UINT) * 6 + 1) * n + (n_threads > 1 || deterministico ?
+		sizeof(UINT) * (2 + 3 * (size_t)(n_threads ? n_threads : 1)) * n : 0));
+
+	biparticao(g, &h);
+	karp_sipser(g, &h);
+	if( n_threads > 1 || deterministico )
+		fases_paralelas(g, &h, n_threads ? n_threads : 1, deterministico);
+	else
+		while( caminho_aumentante(g, &h) );
+
+	for( i = 0; i < g->g_naresta; ++i )
+		g->g_a[i]->a_covered = FALSE;
+	for( i = 0; i < n; ++i ) {
+		g->g_v[i]->v_covered = h.par[i] != NENHUM;
+		if( h.par[i] != NENHUM )
+			g->g_a[h.aresta[i]]->a_covered = TRUE;
+	}
 
-    return 0;
+	free(h.par);
+	free(h.lado);
+	FIM(e_ns_emparelhamento, t0);
 }
 
 //------------------------------------------------------------------------------
-int clique(lista l, grafo g) {
-    UNUSED(g);
+// devolve um grafo com cópias dos vértices de g e as arestas marcadas em
+// a_covered por hopcroft_karp().
+static grafo grafo_emparelhamento(grafo g) {
+	grafo 	empar;
+	vertice	v, *copia;
+	aresta	a;
+	UINT	i;
+
+    empar = novo_grafo(g->g_nome, 0);
+	// copia[i] é a cópia do vértice de índice i de g.
+	copia = (vertice*)mymalloc(sizeof(vertice) * (g->g_nvertices ? g->g_nvertices : 1));
+	for( i = g->g_nvertices; i-- > 0; ) {
+		v = g->g_v[i];
+		copia[i] = novo_vertice(empar, v->v_nome);
+		empar->g_nvertices++;
+	}
+
+	for( i = 0; i < g->g_naresta; ++i ) {
+		a = g->g_a[i];
+		if( a->a_covered ) {
+			nova_aresta(empar, copia[a->a_orig->v_id], copia[a->a_dst->v_id], 0, FALSE);
+			empar->g_naresta++;
+		}
+	}
+	free(copia);
+
+	constroi_csr(empar);
+	return empar;
+}
+
+//------------------------------------------------------------------------------
+// devolve um grafo cujos vertices são cópias de vértices do grafo
+// bipartido g e cujas arestas formam um emparelhamento máximo em g
+//
+// o grafo devolvido, portanto, é vazio ou tem todos os vértices com grau 1
+//
+// não verifica se g é bipartido; caso não seja, o comportamento é indefinido
+grafo emparelhamento_maximo(grafo g) {
+	garante_csr(g);
+	hopcroft_karp(g, 1, FALSE);
+	return grafo_emparelhamento(g);
+}
+
+//------------------------------------------------------------------------------
+// como emparelhamento_maximo(), com as fases divididas entre n_threads
+// threads.
+grafo emparelhamento_maximo_paralelo(grafo g, unsigned int n_threads, int deterministico) {
+	garante_csr(g);
+	hopcroft_karp(g, n_threads, deterministico);
+	return grafo_emparelhamento(g);
+}
+
+/*________________________________________________________________*/
+/*
+ * Aqui comeca o emparelhamento dinamico.
+ *
+ * insere_aresta() e remove_aresta() mantêm o emparelhamento marcado em
+ * a_covered/v_covered. Se ele é máximo antes da alteração, basta uma busca
+ * por caminho aumentante depois dela: uma aresta nova aumenta o emparelhamento
+ * máximo em no máximo 1, e a remoção de uma aresta do emparelhamento o diminui
+ * em no máximo 1 (um caminho aumentante, se houver, termina num dos extremos
+ * da aresta removida).
+ *
+ * As buscas percorrem as listas de vizinhança; a CSR fica desatualizada
+ * (g_v == NULL) e é refeita por garante_csr() no próximo uso.
+ */
+
+// estado de um vértice na busca: cor da bipartição e se já foi alcançado.
+#define COR_NENHUMA		0xff
+#define ALCANCADO		2
+
+//------------------------------------------------------------------------------
+// Refaz a CSR (e o índice de adjacência) de g, se uma alteração a invalidou.
+//
+// As consultas que só leem g podem correr ao mesmo tempo e todas passam por
+// aqui: a reconstrução é feita sob trava_csr e publicada em g_csr_pronta, que
+// as alterações de g (destroi_csr(), destroi_adjacencia()) zeram.
+void garante_csr(grafo g) {
+	if( __atomic_load_n(&g->g_csr_pronta, __ATOMIC_ACQUIRE) )
+		return;
+	pthread_mutex_lock(&trava_csr);
+	if( !g->g_csr_pronta ) {
+		if( !g->g_v )
+			constroi_csr(g);
+		if( g->g_adj.a_ativo && !g->g_adj.a_chaves )
+			constroi_adjacencia(g);
+		__atomic_store_n(&g->g_csr_pronta, TRUE, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&trava_csr);
+}
+
+//------------------------------------------------------------------------------
+// devolve o outro extremo da aresta a de v.
+static vertice outro_extremo(aresta a, vertice v) {
+	return a->a_orig == v ? a->a_dst : a->a_orig;
+}
+
+//------------------------------------------------------------------------------
+// devolve a aresta {u,v} da vizinhança de u, ou NULL.
+static aresta busca_aresta_vertices(vertice u, vertice v) {
+	aresta a;
+
+	for( no n=primeiro_no(u->v_neighborhood_out); n; n=proximo_no(n) ) {
+		a = (aresta)conteudo(n);
+		if( outro_extremo(a, u) == v ) return a;
+	}
+
+	return NULL;
+}
+
+//------------------------------------------------------------------------------
+// devolve a aresta do emparelhamento que cobre v.
+static aresta aresta_coberta(vertice v) {
+	aresta a;
+
+	for( no n=primeiro_no(v->v_neighborhood_out); n; n=proximo_no(n) ) {
+		a = (aresta)conteudo(n);
+		if( a->a_covered ) return a;
+	}
+
+	return NULL;
+}
+
+//------------------------------------------------------------------------------
+// Remove a aresta a (todas as suas ocorrências) da lista l.
+static void remove_aresta_lista(lista l, aresta a) {
+	no n = primeiro_no(l);
+
+	while( n ) {
+		if( conteudo(n) == a ) {
+			remove_no(l, n, NULL);
+			n = primeiro_no(l);
+		} else
+			n = proximo_no(n);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Procura um caminho aumentante nas componentes de s1 e s2 e, se achar,
+// inverte o emparelhamento ao longo dele.
+//
+// As componentes são 2-coloridas por uma busca em largura; em seguida uma
+// busca em largura alternante parte de todos os vértices livres de cor 0
+// delas. pred[v] é a aresta pela qual v foi alcançado.
+//
+// devolve 1 se o emparelhamento aumentou, ou 0 caso contrário.
+static bool aumenta_emparelhamento(grafo g, vertice s1, vertice s2) {
+	UINT	n = g->g_nvertices, ini, fim, c, i;
+	unsigned char* cor;
+	aresta*	pred;
+	vertice* fila, *comp, u, w, x;
+	aresta	a, b;
+	bool	achou = FALSE;
+
+	cor  = (unsigned char*)mymalloc(n ? n : 1);
+	pred = (aresta*)mymalloc(sizeof(aresta) * (n ? n : 1));
+	comp = (vertice*)mymalloc(sizeof(vertice) * 2 * (n ? n : 1));
+	fila = comp + n;
+	registra_auxiliar(g, (1 + sizeof(aresta) + 2 * sizeof(vertice)) * n);
+	memset(cor, COR_NENHUMA, n);
+
+	c = 0;
+	for( i = 0, u = s1; i < 2; ++i, u = s2 ) {
+		if( cor[u->v_id] != COR_NENHUMA ) continue;
+		cor[u->v_id] = 0;
+		ini = c;
+		comp[c++] = u;
+		while( ini < c ) {
+			u = comp[ini++];
+			for( no nn=primeiro_no(u->v_neighborhood_out); nn; nn=proximo_no(nn) ) {
+				w = outro_extremo((aresta)conteudo(nn), u);
+				if( cor[w->v_id] != COR_NENHUMA ) continue;
+				cor[w->v_id] = !cor[u->v_id];
+				comp[c++] = w;
+			}
+		}
+	}
+
+	ini = fim = 0;
+	for( i = 0; i < c; ++i ) {
+		u = comp[i];
+		if( cor[u->v_id] == 0 && !u->v_covered ) {
+			cor[u->v_id] |= ALCANCADO;
+			pred[u->v_id] = NULL;
+			fila[fim++] = u;
+		}
+	}
+
+	while( ini < fim && !achou ) {
+		u = fila[ini++];
+		for( no nn=primeiro_no(u->v_neighborhood_out); nn; nn=proximo_no(nn) ) {
+			a = (aresta)conteudo(nn);
+			w = outro_extremo(a, u);
+			if( a->a_covered || w == u || (cor[w->v_id] & ALCANCADO) ) continue;
+			cor[w->v_id] |= ALCANCADO;
+			pred[w->v_id] = a;
+			if( !w->v_covered ) {
+				achou = TRUE;
+				break;
+			}
+			b = aresta_coberta(w);
+			x = outro_extremo(b, w);
+			if( cor[x->v_id] & ALCANCADO ) continue;
+			cor[x->v_id] |= ALCANCADO;
+			pred[x->v_id] = b;
+			fila[fim++] = x;
+		}
+	}
+
+	if( achou ) {
+		// w é o vértice livre alcançado: inverte o caminho até a origem.
+		w->v_covered = TRUE;
+		for( ;; ) {
+			a = pred[w->v_id];
+			a->a_covered = TRUE;
+			u = outro_extremo(a, w);
+			if( !(b = pred[u->v_id]) ) break;
+			b->a_covered = FALSE;
+			w = outro_extremo(b, u);
+		}
+		u->v_covered = TRUE;
+	}
+
+	free(cor);
+	free(pred);
+	free(comp);
+	CONTA(e_caminhos, achou);
+	CONTA(e_vertices_visitados, fim);
+
+	return achou;
+}
+
+//------------------------------------------------------------------------------
+int insere_aresta(grafo g, vertice u, vertice v) {
+	aresta a;
+
+	if( g->g_tipo || busca_aresta_vertices(u, v) ) return 0;
+
+	a = nova_aresta(g, u, v, 0, g->g_ponderado);
+	g->g_naresta++;
+	destroi_csr(g);
+
+	if( u != v && !u->v_covered && !v->v_covered ) {
+		a->a_covered = u->v_covered = v->v_covered = TRUE;
+		return 1;
+	}
+	aumenta_emparelhamento(g, u, v);
+
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+int remove_aresta(grafo g, vertice u, vertice v) {
+	aresta a;
+
+	if( g->g_tipo || !(a = busca_aresta_vertices(u, v)) ) return 0;
+
+	remove_aresta_lista(u->v_neighborhood_out, a);
+	if( v != u )
+		remove_aresta_lista(v->v_neighborhood_out, a);
+	g->g_naresta--;
+	destroi_csr(g);
+
+	// a estrutura de a volta para a arena, para a próxima insere_aresta().
+	a->a_dst = (vertice)(void*)g->g_arena.a_arestas;
+	g->g_arena.a_arestas = a;
+
+	if( a->a_covered ) {
+		a->a_covered = u->v_covered = v->v_covered = FALSE;
+		aumenta_emparelhamento(g, u, v);
+	}
+
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+// devolve o grafo do emparelhamento mantido por insere_aresta() e
+// remove_aresta() (ver emparelhamento_maximo()).
+grafo emparelhamento_corrente(grafo g) {
+	garante_csr(g);
+	return grafo_emparelhamento(g);
+}
+
+/*
+ * Aqui termina o emparelhamento dinamico.
+ */
+
+
+//------------------------------------------------------------------------------
+// devolve uma lista de vertices com a ordem dos vértices dada por uma 
+// busca em largura lexicográfica
+//
+// A busca é feita por refinamento de partição, em tempo O(|V|+|E|): ordem[]
+// guarda os vértices ainda não visitados agrupados em classes de rótulos
+// iguais, em ordem decrescente de rótulo. O próximo vértice visitado é o
+// primeiro da primeira classe; cada vizinho não visitado dele passa para uma
+// classe nova, logo antes da sua.
+//
+// A lista devolvida está na ordem inversa da visita (ordem de eliminação).
+lista busca_largura_lexicografica_r(grafo g, consulta q) {
+	UINT	n = g->g_nvertices, i, j, k, u, w, c, nova, livres;
+	UINT	*ordem, *pos, *classe, *ini, *fim, *filha, *marca, *pilha;
+	lista 	perf_seq;
+	INICIO(t0);
+	ESTAT(UINT classes = 0, movidos = 0;)
+
+	garante_csr(g);
+	perf_seq = constroi_lista();
+	if( !n ) return perf_seq;
+
+	ordem  = area_consulta(g, q, (size_t)8 * n);
+	pos    = ordem + n;
+	classe = pos + n;
+	ini    = classe + n;
+	fim    = ini + n;
+	filha  = fim + n;
+	marca  = filha + n;
+	pilha  = marca + n;
+
+	// uma única classe, com os vértices na ordem de g_vertices.
+	for( i = 0; i < n; ++i ) {
+		ordem[i] = pos[i] = i;
+		classe[i] = 0;
+		marca[i] = 0;
+		pilha[i] = n - 1 - i;	// índices de classes livres.
+	}
+	livres = n - 1;
+	ini[0] = 0;
+	fim[0] = n;
+
+	for( i = 0; i < n; ++i ) {
+		u = ordem[i];
+		c = classe[u];
+		if( ++ini[c] == fim[c] )
+			pilha[livres++] = c;
+		insere_lista(g->g_v[u], perf_seq);
+
+		for( k = g->g_out.c_inicio[u]; k < g->g_out.c_inicio[u+1]; ++k ) {
+			w = g->g_out.c_viz[k];
+			if( pos[w] <= i ) continue;
+			c = classe[w];
+			// w já passou para uma classe criada por u (aresta múltipla).
+			if( marca[c] == i + 1 && filha[c] == c ) continue;
+			if( marca[c] != i + 1 ) {
+				// primeira vez que c é refinada por u: cria a classe filha,
+				// vazia, no início de c.
+				marca[c] = i + 1;
+				nova = pilha[--livres];
+				marca[nova] = i + 1;
+				filha[nova] = nova;
+				ini[nova] = fim[nova] = ini[c];
+				filha[c] = nova;
+				ESTAT(++classes;)
+			}
+			nova = filha[c];
+			// troca w com o primeiro de c e avança a fronteira entre as duas.
+			j = ini[c];
+			ordem[pos[w]] = ordem[j];
+			pos[ordem[j]] = pos[w];
+			ordem[j] = w;
+			pos[w] = j;
+			classe[w] = nova;
+			fim[nova]++;
+			if( ++ini[c] == fim[c] )
+				pilha[livres++] = c;
+			ESTAT(++movidos;)
+		}
+	}
+	CONTA(e_lex_classes, classes);
+	CONTA(e_lex_movidos, movidos);
+	FIM(e_ns_busca, t0);
+
+	return perf_seq;
+}
+
+//------------------------------------------------------------------------------
+lista busca_largura_lexicografica(grafo g) {
+	struct consulta	q = { NULL, 0 };
+	lista			l = busca_largura_lexicografica_r(g, &q);
+
+	free(q.c_vet);
+	return l;
+}
+
+//------------------------------------------------------------------------------
+// devolve uma lista de vertices com a ordem dos vértices dada por uma
+// busca de cardinalidade máxima (MCS)
+//
+// O próximo vértice visitado é um vértice não visitado com o maior número de
+// vizinhos já visitados (seu peso). Os vértices não visitados ficam em
+// baldes (listas duplamente encadeadas em vetores) indexados pelo peso; o
+// maior peso não vazio só cresce de 1 por vizinho e só decresce quando seu
+// balde esvazia, de forma que o tempo é O(|V|+|E|).
+//
+// A lista devolvida está na ordem inversa da visita (ordem de eliminação).
+lista busca_cardinalidade_maxima_r(grafo g, consulta q) {
+	UINT	n = g->g_nvertices, i, k, u, w, j, max;
+	UINT	*balde, *prox, *ant, *peso;
+	lista	perf_seq;
+	INICIO(t0);
+	ESTAT(UINT movidos = 0;)
+
+	garante_csr(g);
+	perf_seq = constroi_lista();
+	if( !n ) return perf_seq;
+
+	// o peso de um vértice não passa do seu grau (arestas múltiplas contam).
+	for( i = 0, max = 0; i < n; ++i )
+		if( g->g_out.c_inicio[i+1] - g->g_out.c_inicio[i] > max )
+			max = g->g_out.c_inicio[i+1] - g->g_out.c_inicio[i];
+	prox  = area_consulta(g, q, (size_t)3 * n + max + 1);
+	balde = prox + 3 * n;
+	ant   = prox + n;
+	peso  = ant + n;
+	for( i = 0; i <= max; ++i )
+		balde[i] = NENHUM;
+
+	// todos no balde 0, na ordem de g_vertices.
+	for( i = 0; i < n; ++i ) {
+		peso[i] = 0;
+		prox[i] = i + 1 < n ? i + 1 : NENHUM;
+		ant[i] = i ? i - 1 : NENHUM;
+	}
+	balde[0] = 0;
+
+	j = 0;
+	for( i = 0; i < n; ++i ) {
+		while( balde[j] == NENHUM ) --j;
+		u = balde[j];
+		balde[j] = prox[u];
+		if( prox[u] != NENHUM ) ant[prox[u]] = NENHUM;
+		peso[u] = NENHUM;
+		insere_lista(g->g_v[u], perf_seq);
+
+		for( k = g->g_out.c_inicio[u]; k < g->g_out.c_inicio[u+1]; ++k ) {
+			w = g->g_out.c_viz[k];
+			if( peso[w] == NENHUM ) continue;
+			// tira w do balde peso[w] e o põe no início do seguinte.
+			if( ant[w] != NENHUM ) prox[ant[w]] = prox[w];
+			else balde[peso[w]] = prox[w];
+			if( prox[w] != NENHUM ) ant[prox[w]] = ant[w];
+			++peso[w];
+			prox[w] = balde[peso[w]];
+			ant[w] = NENHUM;
+			if( prox[w] != NENHUM ) ant[prox[w]] = w;
+			balde[peso[w]] = w;
+			if( peso[w] > j ) j = peso[w];
+			ESTAT(++movidos;)
+		}
+	}
+	CONTA(e_mcs_movidos, movidos);
+	FIM(e_ns_busca, t0);
+
+	return perf_seq;
+}
+
+//------------------------------------------------------------------------------
+lista busca_cardinalidade_maxima(grafo g) {
+	struct consulta	q = { NULL, 0 };
+	lista			l = busca_cardinalidade_maxima_r(g, &q);
+
+	free(q.c_vet);
+	return l;
+}
+
+//------------------------------------------------------------------------------
+// devolve 1, se a lista l representa uma 
+//            ordem perfeita de eliminação para o grafo g ou
+//         0, caso contrário
+//
+// Teste de Tarjan e Yannakakis: o pai de v é o primeiro vizinho de v à sua
+// direita na lista. l é ordem perfeita de eliminação se, para todo v, os
+// demais vizinhos de v à direita são vizinhos do pai de v. Os vértices são
+// percorridos da esquerda para a direita; ao chegar em w, marca[x] = w para
+// w e seus vizinhos x à esquerda, e cada um desses x com pai já definido
+// precisa ter o pai marcado.
+//
+// o tempo de execução é O(|V(G)|+|E(G)|)
+int ordem_perfeita_eliminacao_r(lista l, grafo g, consulta q) {
+	UINT	n = g->g_nvertices, i, k, w, x, count;
+	UINT	*pos, *ordem, *pai, *marca;
+	no		nv;
+	int		ret = 1;
+	INICIO(t0);
+	ESTAT(UINT testes = 0;)
+
+	garante_csr(g);
+	if( !n ) return 1;
+
+	pos   = area_consulta(g, q, (size_t)4 * n);
+	ordem = pos + n;
+	pai   = ordem + n;
+	marca = pai + n;
+	for( i = 0; i < n; ++i )
+		pos[i] = NENHUM;
+
+	count = 0;
+	for( nv=primeiro_no(l); nv && count < n; nv=proximo_no(nv) ) {
+		w = ((vertice)conteudo(nv))->v_id;
+		pos[w] = count;
+		ordem[count++] = w;
+	}
+
+	for( i = 0; i < count && ret; ++i ) {
+		w = ordem[i];
+		pai[w] = w;
+		marca[w] = w;
+		for( k = g->g_out.c_inicio[w]; k < g->g_out.c_inicio[w+1]; ++k ) {
+			x = g->g_out.c_viz[k];
+			if( pos[x] >= i ) continue;
+			// x está à esquerda de w.
+			marca[x] = w;
+			if( pai[x] == x )
+				pai[x] = w;
+		}
+		for( k = g->g_out.c_inicio[w]; k < g->g_out.c_inicio[w+1]; ++k ) {
+			x = g->g_out.c_viz[k];
+			if( pos[x] >= i ) continue;
+			ESTAT(++testes;)
+			if( marca[pai[x]] != w ) {
+				// um vizinho à direita de x não é vizinho do pai de x.
+				ret = 0;
+				break;
+			}
+		}
+	}
+	CONTA(e_eliminacao_testes, testes);
+	FIM(e_ns_eliminacao, t0);
+
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+int ordem_perfeita_eliminacao(lista l, grafo g) {
+	struct consulta	q = { NULL, 0 };
+	int				r = ordem_perfeita_eliminacao_r(l, g, &q);
+
+	free(q.c_vet);
+	return r;
+}
+
+//------------------------------------------------------------------------------
+// Saída bufferizada de escreve_grafo(): o texto é formatado em s_buf e
+// escrito com fwrite() quando o buffer enche.
+#define TAM_SAIDA	(1u << 18)
+
+struct saida {
+	char*	s_buf;
+	size_t	s_n;			// bytes ocupados em s_buf.
+	FILE*	s_out;
+	bool	s_erro;
+	int		padding;
+};
+
+//------------------------------------------------------------------------------
+static void descarrega_saida(struct saida* s) {
+	if( s->s_n && fwrite(s->s_buf, 1, s->s_n, s->s_out) != s->s_n )
+		s->s_erro = TRUE;
+	s->s_n = 0;
+}
+
+//------------------------------------------------------------------------------
+static void emite_bytes(struct saida* s, const char* p, size_t n) {
+	if( s->s_n + n > TAM_SAIDA ) {
+		descarrega_saida(s);
+		if( n > TAM_SAIDA ) {
+			if( fwrite(p, 1, n, s->s_out) != n ) s->s_erro = TRUE;
+			return;
+		}
+	}
+	memcpy(s->s_buf + s->s_n, p, n);
+	s->s_n += n;
+}
+
+//------------------------------------------------------------------------------
+static void emite_str(struct saida* s, const char* p) {
+	emite_bytes(s, p, strlen(p));
+}
+
+//------------------------------------------------------------------------------
+// Emite x em decimal.
+static void emite_long(struct saida* s, LINT x) {
+	char			dig[24];
+	size_t			i = sizeof(dig);
+	unsigned long	u = x < 0 ? 0ul - (unsigned long)x : (unsigned long)x;
+
+	do {
+		dig[--i] = (char)('0' + u % 10);
+		u /= 10;
+	} while( u );
+	if( x < 0 ) dig[--i] = '-';
+	emite_bytes(s, dig + i, sizeof(dig) - i);
+}
+
+//------------------------------------------------------------------------------
+grafo escreve_grafo(FILE *output, grafo g) {
+    struct saida	s;
+    aresta 	e;
+    UINT	i, k;
+    size_t*	tam;
+
+    if( !g ) return NULL;
+    INICIO(t0);
+    garante_csr(g);
+    s.s_buf = (char*)mymalloc(TAM_SAIDA);
+    s.s_n = 0;
+    s.s_out = output;
+    s.s_erro = FALSE;
+    // tamanho dos nomes, indexado pelo índice do vértice.
+    tam = (size_t*)mymalloc(sizeof(size_t) * (g->g_nvertices ? g->g_nvertices : 1));
+    registra_auxiliar(g, TAM_SAIDA + sizeof(size_t) * g->g_nvertices);
+    for( i = 0; i < g->g_nvertices; ++i )
+        tam[i] = strlen(g->g_v[i]->v_nome);
+
+    emite_str(&s, direcionado(g) ? "strict digraph \"" : "strict graph \"");
+    emite_str(&s, g->g_nome ? g->g_nome : "(null)");
+    emite_str(&s, "\" {\n\n");
+
+    for( i = 0; i < g->g_nvertices; ++i ) {
+        emite_bytes(&s, "    \"", 5);
+        emite_bytes(&s, g->g_v[i]->v_nome, tam[i]);
+        emite_bytes(&s, "\"\n", 2);
+    }
+    emite_str(&s, "\n");
+
+	for( i = 0; i < g->g_nvertices; ++i ) {
+		for( k = g->g_out.c_inicio[i]; k < g->g_out.c_inicio[i+1]; ++k ) {
+			// num grafo não direcionado a aresta é escrita só na vizinhança
+			// do extremo de menor índice.
+			if( !g->g_tipo && g->g_out.c_viz[k] < i ) continue;
+			e = g->g_a[g->g_out.c_aresta[k]];
+			emite_bytes(&s, "    \"", 5);
+			emite_bytes(&s, e->a_orig->v_nome, tam[e->a_orig->v_id]);
+			emite_bytes(&s, g->g_tipo ? "\" -> \"" : "\" -- \"", 6);
+			emite_bytes(&s, e->a_dst->v_nome, tam[e->a_dst->v_id]);
+			if ( g->g_ponderado ) {
+				emite_bytes(&s, "\" [peso=", 8);
+				emite_long(&s, g->g_out.c_peso[k]);
+				emite_bytes(&s, "]\n", 2);
+			} else
+				emite_bytes(&s, "\"\n", 2);
+		}
+	}
+    emite_str(&s, "}\n");
+
+    descarrega_saida(&s);
+    free(s.s_buf);
+    free(tam);
+    FIM(e_ns_escrita, t0);
+
+    return s.s_erro ? NULL : g;
+}
+
+//------------------------------------------------------------------------------
+// devolve 1, se o conjunto dos vertices em l é uma clique em g, ou
+//         0, caso contrário
+//
+// um conjunto C de vértices de um grafo é uma clique em g
+// se todo vértice em C é vizinho de todos os outros vértices de C em g
+int are_neighbors(grafo g, vertice v1, vertice v2) {
+	UINT	k;
+
+    if( g->g_adj.a_chaves )
+        return adjacentes_indice(&g->g_adj, v1->v_id, v2->v_id);
+
+    for( k = g->g_out.c_inicio[v1->v_id]; k < g->g_out.c_inicio[v1->v_id+1]; ++k )
+        if( g->g_out.c_viz[k] == v2->v_id )
+            return 1;
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+int clique(lista l, grafo g) {
     no		n, n2;
     vertice	v, v2;
 
+    garante_csr(g);
+
     for( n=primeiro_no(l); n; n = proximo_no(n)) {
         v = conteudo(n);
         for( n2=proximo_no(n); n2; n2=proximo_no(n2)) {
             v2 = conteudo(n2);
-            if( !are_neighbors(v, v2) )
+            if( !are_neighbors(g, v, v2) )
                 return 0;
         }
     }
@@ -679,409 +2105,2194 @@ int clique(lista l, grafo g) {
 //         0, caso contrário
 //
 // um vértice é simplicial no grafo se sua vizinhança é uma clique
+//
+// Como clique() aplicada à vizinhança de v, mas percorrendo direto o trecho
+// de v na CSR, sem construir a lista.
 int simplicial(vertice v, grafo g) {
-    no		n;
-    lista 	l = constroi_lista();
-    aresta	a;
-    int		ret;
-
-    for( n=primeiro_no(v->v_neighborhood_out); n; n=proximo_no(n)) {
-        a = conteudo(n);
-        insere_lista(a->a_dst == v ? a->a_orig : a->a_dst, l);
-    }
+    UINT	i, k, fim;
+
+    garante_csr(g);
+
+    fim = g->g_out.c_inicio[v->v_id+1];
+    for( i = g->g_out.c_inicio[v->v_id]; i < fim; ++i )
+        for( k = i + 1; k < fim; ++k )
+            if( !are_neighbors(g, g->g_v[g->g_out.c_viz[i]], g->g_v[g->g_out.c_viz[k]]) )
+                return 0;
+
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+// Classificação de todos os vértices de g em simpliciais ou não, dividida
+// em blocos de SIMP_BLOCO vértices distribuídos entre threads.
+#define SIMP_BLOCO	1024u
+
+struct simpliciais {
+	UINT*	s_inicio;		// vizinhanças ordenadas, sem repetições nem laços.
+	UINT*	s_viz;
+	unsigned char* s_simp;	// 1 se o vértice é simplicial.
+	UINT	s_n;
+	UINT	s_proximo;		// próximo bloco a processar (atômico).
+};
+
+struct trabalhador_simp {
+	struct simpliciais*	t_s;
+	UINT*		t_marca;	// marca[w] == v se w é vizinho de v.
+	pthread_t	t_thread;
+};
+
+//------------------------------------------------------------------------------
+// devolve 1 se w está no vetor ordenado viz[ini..fim), ou 0 caso contrário.
+static bool busca_ordenada(const UINT* viz, UINT ini, UINT fim, UINT w) {
+	UINT meio;
+
+	while( ini < fim ) {
+		meio = ini + (fim - ini) / 2;
+		if( viz[meio] < w ) ini = meio + 1;
+		else if( viz[meio] > w ) fim = meio;
+		else return TRUE;
+	}
+
+	return FALSE;
+}
+
+//------------------------------------------------------------------------------
+// devolve 1 se v é simplicial: todo vizinho u de v tem os outros d-1
+// vizinhos de v na sua vizinhança. Conta-os com as marcas, ou os procura na
+// vizinhança ordenada de u, se u tem grau muito maior que v.
+static bool testa_simplicial(const struct simpliciais* s, UINT v, UINT* marca) {
+	UINT	d = s->s_inicio[v+1] - s->s_inicio[v], du, k, j, u, count;
+
+	if( d <= 1 ) return TRUE;
+
+	for( k = s->s_inicio[v]; k < s->s_inicio[v+1]; ++k )
+		marca[s->s_viz[k]] = v;
+
+	for( k = s->s_inicio[v]; k < s->s_inicio[v+1]; ++k ) {
+		u = s->s_viz[k];
+		du = s->s_inicio[u+1] - s->s_inicio[u];
+		if( du < d - 1 ) return FALSE;
+		if( du <= 8 * d ) {
+			count = 0;
+			for( j = s->s_inicio[u]; j < s->s_inicio[u+1]; ++j )
+				if( marca[s->s_viz[j]] == v ) ++count;
+			if( count != d - 1 ) return FALSE;
+		} else {
+			for( j = s->s_inicio[v]; j < s->s_inicio[v+1]; ++j )
+				if( j != k && !busca_ordenada(s->s_viz, s->s_inicio[u], s->s_inicio[u+1], s->s_viz[j]) )
+					return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+//------------------------------------------------------------------------------
+// Classifica os vértices dos blocos ainda não processados.
+static void* classifica_simpliciais(void* arg) {
+	struct trabalhador_simp*	t = (struct trabalhador_simp*)arg;
+	struct simpliciais*			s = t->t_s;
+	UINT	b, v, fim;
+
+	while( (b = __atomic_fetch_add(&s->s_proximo, 1, __ATOMIC_RELAXED)) * SIMP_BLOCO < s->s_n ) {
+		fim = s->s_n - b * SIMP_BLOCO > SIMP_BLOCO ? (b + 1) * SIMP_BLOCO : s->s_n;
+		for( v = b * SIMP_BLOCO; v < fim; ++v )
+			s->s_simp[v] = (unsigned char)testa_simplicial(s, v, t->t_marca);
+	}
+
+	return NULL;
+}
+
+//------------------------------------------------------------------------------
+// Preenche as vizinhanças ordenadas de s transpondo a CSR de g: percorrendo
+// os vértices u em ordem e acrescentando u à vizinhança de cada vizinho w,
+// cada vizinhança fica em ordem crescente. Repetições e laços são omitidos.
+static void ordena_vizinhancas(grafo g, struct simpliciais* s) {
+	UINT	n = g->g_nvertices, u, w, k, *fim;
+
+	s->s_inicio = (UINT*)mymalloc(sizeof(UINT) * (n + 1));
+	s->s_viz = (UINT*)mymalloc(sizeof(UINT) * (g->g_out.c_inicio[n] ? g->g_out.c_inicio[n] : 1));
+	fim = (UINT*)mymalloc(sizeof(UINT) * (n ? n : 1));
+	memset(s->s_inicio, 0, sizeof(UINT) * (n + 1));
+	for( k = 0; k < g->g_out.c_inicio[n]; ++k )
+		s->s_inicio[g->g_out.c_viz[k] + 1]++;
+	for( u = 0; u < n; ++u ) {
+		s->s_inicio[u+1] += s->s_inicio[u];
+		fim[u] = s->s_inicio[u];
+	}
+	for( u = 0; u < n; ++u ) {
+		for( k = g->g_out.c_inicio[u]; k < g->g_out.c_inicio[u+1]; ++k ) {
+			w = g->g_out.c_viz[k];
+			if( w == u || (fim[w] > s->s_inicio[w] && s->s_viz[fim[w]-1] == u) ) continue;
+			s->s_viz[fim[w]++] = u;
+		}
+	}
+
+	// compacta, removendo as posições das repetições e dos laços.
+	for( u = 0, k = 0; u < n; ++u ) {
+		w = s->s_inicio[u];
+		s->s_inicio[u] = k;
+		memmove(s->s_viz + k, s->s_viz + w, sizeof(UINT) * (fim[u] - w));
+		k += fim[u] - w;
+	}
+	s->s_inicio[n] = k;
+	free(fim);
+}
+
+//------------------------------------------------------------------------------
+lista vertices_simpliciais_paralelo(grafo g, unsigned int n_threads) {
+	struct simpliciais			s;
+	struct trabalhador_simp*	t;
+	UINT	n, i;
+	lista	l;
+
+	garante_csr(g);
+	n = g->g_nvertices;
+	if( !n_threads ) n_threads = 1;
+
+	memset(&s, 0, sizeof(struct simpliciais));
+	s.s_n = n;
+	ordena_vizinhancas(g, &s);
+	registra_auxiliar(g, sizeof(UINT) * (n + 1 + (size_t)g->g_out.c_inicio[n] + (size_t)n_threads * n) + n);
+	s.s_simp = (unsigned char*)mymalloc(n ? n : 1);
+
+	t = (struct trabalhador_simp*)mymalloc(sizeof(struct trabalhador_simp) * n_threads);
+	for( i = 0; i < n_threads; ++i ) {
+		t[i].t_s = &s;
+		t[i].t_marca = (UINT*)mymalloc(sizeof(UINT) * (n ? n : 1));
+		memset(t[i].t_marca, 0xff, sizeof(UINT) * n);
+		if( i && pthread_create(&t[i].t_thread, NULL, classifica_simpliciais, &t[i]) ) {
+			perror("Could not create thread!");
+			exit(EXIT_FAILURE);
+		}
+	}
+	classifica_simpliciais(&t[0]);
+	for( i = 1; i < n_threads; ++i )
+		pthread_join(t[i].t_thread, NULL);
+
+	l = constroi_lista();
+	for( i = n; i-- > 0; )
+		if( s.s_simp[i] )
+			insere_lista(g->g_v[i], l);
+
+	for( i = 0; i < n_threads; ++i )
+		free(t[i].t_marca);
+	free(t);
+	free(s.s_simp);
+	free(s.s_inicio);
+	free(s.s_viz);
+
+	return l;
+}
+
+//------------------------------------------------------------------------------
+lista vertices_simpliciais(grafo g) {
+	return vertices_simpliciais_paralelo(g, 1);
+}
+
+//------------------------------------------------------------------------------
+// Copia a CSR c de um grafo com n vértices para d.
+static void copia_csr(struct csr* d, const struct csr* c, UINT n) {
+	size_t	k = c->c_inicio[n];
+	UINT	*inicio, *viz, *ar;
+	LINT*	peso;
+
+	inicio = (UINT*)mymalloc(sizeof(UINT) * (n + 1));
+	viz    = (UINT*)mymalloc(sizeof(UINT) * (k ? k : 1));
+	ar     = (UINT*)mymalloc(sizeof(UINT) * (k ? k : 1));
+	peso   = (LINT*)mymalloc(sizeof(LINT) * (k ? k : 1));
+	memcpy(inicio, c->c_inicio, sizeof(UINT) * (n + 1));
+	memcpy(viz, c->c_viz, sizeof(UINT) * k);
+	memcpy(ar, c->c_aresta, sizeof(UINT) * k);
+	memcpy(peso, c->c_peso, sizeof(LINT) * k);
+	d->c_inicio = inicio;
+	d->c_viz = viz;
+	d->c_aresta = ar;
+	d->c_peso = peso;
+}
+
+//------------------------------------------------------------------------------
+// devolve um grafo igual a g
+//
+// A cópia é estrutural: vértices e arestas são copiados na ordem dos índices,
+// com os extremos das arestas traduzidos pelos índices (sem busca por nome),
+// e a CSR, o índice de nomes e o índice de adjacência são copiados em bloco.
+// Vértices, nomes, arestas e nós das listas ocupam um único bloco da arena.
+grafo copia_grafo(grafo g) {
+	grafo	c;
+	vertice	v, vs;
+	aresta	a;
+	char*	nomes;
+	size_t	tam_nomes, nos, t;
+	UINT	n, m, i;
+
+	if( !g ) return NULL;
+	garante_csr(g);
+	n = g->g_nvertices;
+	m = g->g_naresta;
+
+	c = novo_grafo(g->g_nome, g->g_tipo);
+	c->g_ponderado = g->g_ponderado;
+	c->g_nvertices = n;
+	c->g_naresta = m;
+	c->g_v = (vertice*)mymalloc(sizeof(vertice) * (n ? n : 1));
+	c->g_a = (aresta*)mymalloc(sizeof(aresta) * (m ? m : 1));
+
+	tam_nomes = 0;
+	nos = n;
+	for( i = 0; i < n; ++i ) {
+		vs = g->g_v[i];
+		tam_nomes += strlen(vs->v_nome) + 1;
+		nos += tamanho_lista(vs->v_neighborhood_out) + tamanho_lista(vs->v_neighborhood_in);
+	}
+	reserva_arena(&c->g_arena, (size_t)n * (sizeof(struct vertice) + 2 * sizeof(struct lista))
+		+ (size_t)m * sizeof(struct aresta) + nos * sizeof(struct no) + tam_nomes + 32);
+
+	// vértices (e g_vertices) na ordem dos índices.
+	nomes = (char*)aloca_arena(&c->g_arena, tam_nomes ? tam_nomes : 1);
+	v = (vertice)aloca_arena(&c->g_arena, sizeof(struct vertice) * (n ? n : 1));
+	for( i = 0; i < n; ++i ) {
+		vs = g->g_v[i];
+		t = strlen(vs->v_nome) + 1;
+		v[i] = *vs;
+		v[i].v_nome = memcpy(nomes, vs->v_nome, t);
+		v[i].v_neighborhood_in = constroi_lista_arena(&c->g_arena);
+		v[i].v_neighborhood_out = constroi_lista_arena(&c->g_arena);
+		c->g_v[i] = &v[i];
+		nomes += t;
+	}
+	for( i = n; i-- > 0; )
+		if( !insere_lista(c->g_v[i], c->g_vertices) ) exit(EXIT_FAILURE);
+
+	a = (aresta)aloca_arena(&c->g_arena, sizeof(struct aresta) * (m ? m : 1));
+	for( i = 0; i < m; ++i ) {
+		a[i] = *g->g_a[i];
+		a[i].a_orig = c->g_v[g->g_a[i]->a_orig->v_id];
+		a[i].a_dst = c->g_v[g->g_a[i]->a_dst->v_id];
+		c->g_a[i] = &a[i];
+	}
+
+	copia_csr(&c->g_out, &g->g_out, n);
+	if( g->g_tipo )
+		copia_csr(&c->g_in, &g->g_in, n);
+	for( i = 0; i < n; ++i ) {
+		lista_da_csr(c, &c->g_out, i, c->g_v[i]->v_neighborhood_out);
+		if( g->g_tipo )
+			lista_da_csr(c, &c->g_in, i, c->g_v[i]->v_neighborhood_in);
+	}
+
+	// os índices guardam vértices: só os apontadores mudam.
+	if( g->g_indice.i_vert ) {
+		t = (size_t)g->g_indice.i_mascara + 1;
+		c->g_indice = g->g_indice;
+		c->g_indice.i_vert = (vertice*)mymalloc(sizeof(vertice) * t);
+		c->g_indice.i_hash = (UINT*)mymalloc(sizeof(UINT) * t);
+		memcpy(c->g_indice.i_hash, g->g_indice.i_hash, sizeof(UINT) * t);
+		for( i = 0; i < t; ++i )
+			c->g_indice.i_vert[i] = g->g_indice.i_vert[i] ? c->g_v[g->g_indice.i_vert[i]->v_id] : NULL;
+	}
+	c->g_adj.a_ativo = g->g_adj.a_ativo;
+	if( g->g_adj.a_chaves ) {
+		t = (size_t)g->g_adj.a_mascara + 1;
+		c->g_adj.a_mascara = g->g_adj.a_mascara;
+		c->g_adj.a_chaves = (uint64_t*)mymalloc(sizeof(uint64_t) * t);
+		memcpy(c->g_adj.a_chaves, g->g_adj.a_chaves, sizeof(uint64_t) * t);
+	}
+
+	return c;
+}
+
+//------------------------------------------------------------------------------
+// Registra que um algoritmo usou tam bytes de área de trabalho em g (o maior
+// valor fica em g_pico_aux). Consultas podem chamar ao mesmo tempo.
+static void registra_auxiliar(grafo g, size_t tam) {
+	size_t pico = __atomic_load_n(&g->g_pico_aux, __ATOMIC_RELAXED);
+
+	while( tam > pico &&
+		!__atomic_compare_exchange_n(&g->g_pico_aux, &pico, tam, FALSE,
+			__ATOMIC_RELAXED, __ATOMIC_RELAXED) );
+}
+
+//------------------------------------------------------------------------------
+// Bytes da CSR c de um grafo com n vértices.
+static size_t memoria_csr(const struct csr* c, UINT n) {
+	if( !c->c_inicio ) return 0;
+
+	return sizeof(UINT) * (n + 1) + (sizeof(UINT) * 2 + sizeof(LINT)) * c->c_inicio[n];
+}
+
+//------------------------------------------------------------------------------
+// devolve o número de bytes ocupados por g e, se m != NULL, preenche *m
+//
+// Os vértices, nomes, arestas e listas são contados pelo que ocupam na arena
+// (ou no snapshot binário); nós e arestas removidos, guardados para reúso,
+// ficam em m_reuso, e o que sobra dos blocos da arena é m_arena_livre.
+//
+// A consulta não altera g: se a CSR foi descartada por uma alteração, ela e
+// os vetores de vértices e de arestas não são contados. O custo é O(|V|).
+size_t memoria_grafo(grafo g, struct memoria* m) {
+	struct memoria	r;
+	struct bloco*	b;
+	vertice	v;
+	aresta	a;
+	size_t	nos = 0, n_v, n_a, usado;
+
+	memset(&r, 0, sizeof(struct memoria));
+	if( !g ) {
+		if( m ) *m = r;
+		return 0;
+	}
+
+	n_v = tamanho_lista(g->g_vertices);
+	for( no n = primeiro_no(g->g_vertices); n; n = proximo_no(n) ) {
+		v = (vertice)conteudo(n);
+		r.m_nomes += strlen(v->v_nome) + 1;
+		nos += tamanho_lista(v->v_neighborhood_in) + tamanho_lista(v->v_neighborhood_out);
+	}
+	nos += n_v;
+	for( no n = g->g_arena.a_nos; n; n = n->proximo )
+		r.m_reuso += sizeof(struct no);
+	for( a = g->g_arena.a_arestas; a; a = (aresta)(void*)a->a_dst )
+		r.m_reuso += sizeof(struct aresta);
+	if( g->g_nome )
+		r.m_nomes += strlen(g->g_nome) + 1;
+
+	// g_v e g_a só existem junto com a CSR.
+	n_a = g->g_v ? g->g_naresta : 0;
+	r.m_grafo = sizeof(struct grafo);
+	r.m_vertices = sizeof(struct vertice) * n_v + (g->g_v ? sizeof(vertice) * n_v : 0);
+	r.m_arestas = sizeof(struct aresta) * g->g_naresta + sizeof(aresta) * n_a;
+	r.m_listas = sizeof(struct lista) * (2 * n_v + 1) + sizeof(struct no) * nos;
+	if( g->g_v && !g->g_csr_mapeada )
+		r.m_csr = memoria_csr(&g->g_out, g->g_nvertices) + memoria_csr(&g->g_in, g->g_nvertices);
+	if( g->g_indice.i_vert )
+		r.m_indice = (sizeof(vertice) + sizeof(UINT)) * ((size_t)g->g_indice.i_mascara + 1);
+	if( g->g_adj.a_chaves )
+		r.m_adjacencia = sizeof(uint64_t) * ((size_t)g->g_adj.a_mascara + 1);
+	for( b = g->g_arena.a_blocos; b; b = b->b_prox )
+		r.m_arena += sizeof(struct bloco) + b->b_tam;
+	r.m_mapa = g->g_mapa.e_mapa ? g->g_mapa.e_tam_mapa : g->g_mapa.e_buf ? g->g_mapa.e_tam : 0;
+
+	// g_v e g_a não estão na arena; os nomes de um snapshot estão no mapa.
+	usado = sizeof(struct vertice) * n_v + sizeof(struct aresta) * g->g_naresta
+		+ r.m_listas + r.m_reuso + (g->g_mapa.e_buf ? 0 : r.m_nomes);
+	r.m_arena_livre = r.m_arena > usado ? r.m_arena - usado : 0;
+	r.m_total = r.m_grafo + r.m_arena + (r.m_vertices - sizeof(struct vertice) * n_v)
+		+ sizeof(aresta) * n_a + r.m_csr + r.m_indice + r.m_adjacencia + r.m_mapa;
+	r.m_pico_auxiliar = __atomic_load_n(&g->g_pico_aux, __ATOMIC_RELAXED);
+
+	if( m ) *m = r;
+	return r.m_total;
+}
+
+/*________________________________________________________________*/
+/*
+ * Aqui comeca a reordenacao dos vertices.
+ *
+ * reordena_grafo() calcula uma nova ordem dos vértices, reescreve nessa
+ * ordem a lista g_vertices e as listas de vizinhança (cada uma ordenada pelo
+ * novo índice do vizinho) e reconstrói a CSR, que numera vértices e arestas
+ * pela ordem das listas. Os vértices (e seus nomes) não mudam de endereço.
+ */
+
+//------------------------------------------------------------------------------
+static int compara_chaves(const void* a, const void* b) {
+	uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+
+	return (x > y) - (x < y);
+}
+
+//------------------------------------------------------------------------------
+// Número de vizinhos de u (de entrada e de saída, se g é direcionado).
+static UINT grau_total(grafo g, UINT u) {
+	UINT d = g->g_out.c_inicio[u+1] - g->g_out.c_inicio[u];
+
+	if( g->g_tipo )
+		d += g->g_in.c_inicio[u+1] - g->g_in.c_inicio[u];
+
+	return d;
+}
+
+//------------------------------------------------------------------------------
+// Busca em largura a partir de s (ainda não visitado), acrescentando os
+// vértices a ordem[*fim..]. Com cm != 0 os vizinhos de cada vértice são
+// visitados em ordem crescente de grau (Cuthill-McKee), usando chave como
+// área de ordenação.
+static void largura_ordem(grafo g, UINT s, UINT* ordem, UINT* fim, bool* visto,
+	bool cm, uint64_t* chave) {
+	const struct csr*	c[2] = { &g->g_out, &g->g_in };
+	UINT	ini = *fim, u, k, j, nc;
+
+	visto[s] = TRUE;
+	ordem[(*fim)++] = s;
+	while( ini < *fim ) {
+		u = ordem[ini++];
+		nc = 0;
+		for( j = 0; j < (g->g_tipo ? 2u : 1u); ++j ) {
+			for( k = c[j]->c_inicio[u]; k < c[j]->c_inicio[u+1]; ++k ) {
+				UINT w = c[j]->c_viz[k];
+				if( visto[w] ) continue;
+				visto[w] = TRUE;
+				if( cm )
+					chave[nc++] = (uint64_t)grau_total(g, w) << 32 | w;
+				else
+					ordem[(*fim)++] = w;
+			}
+		}
+		if( cm ) {
+			qsort(chave, nc, sizeof(uint64_t), compara_chaves);
+			for( k = 0; k < nc; ++k )
+				ordem[(*fim)++] = (UINT)chave[k];
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Reescreve a lista de vizinhança l de v ordenada pelo novo índice (pos) do
+// outro extremo de cada aresta. As duas ocorrências de um laço (grafo não
+// direcionado) continuam consecutivas porque o desempate é pelo índice da
+// aresta.
+static void ordena_lista(grafo g, vertice v, lista l, const UINT* pos, uint64_t* chave) {
+	UINT	k = 0;
+	aresta	a;
+	no		n;
+
+	for( n = primeiro_no(l); n; n = proximo_no(n) ) {
+		a = (aresta)conteudo(n);
+		chave[k++] = (uint64_t)pos[(a->a_orig == v ? a->a_dst : a->a_orig)->v_id] << 32 | a->a_id;
+	}
+	qsort(chave, k, sizeof(uint64_t), compara_chaves);
+	k = 0;
+	for( n = primeiro_no(l); n; n = proximo_no(n) )
+		n->conteudo = g->g_a[(UINT)chave[k++]];
+}
+
+//------------------------------------------------------------------------------
+// renumera os vértices e as arestas de g segundo criterio (ver grafo.h)
+//
+// devolve 1 em caso de sucesso, ou
+//         0 se criterio é inválido
+int reordena_grafo(grafo g, int criterio) {
+	UINT		n, i, fim, maior;
+	UINT		*ordem, *pos;
+	uint64_t*	chave;
+	bool*		visto;
+	no			nv;
+
+	if( criterio != ORDEM_LARGURA && criterio != ORDEM_CUTHILL_MCKEE && criterio != ORDEM_GRAU )
+		return 0;
+	garante_csr(g);
+	n = g->g_nvertices;
+	if( !n ) return 1;
+
+	for( i = 0, maior = 0; i < n; ++i ) {
+		UINT t = tamanho_lista(g->g_v[i]->v_neighborhood_out) + tamanho_lista(g->g_v[i]->v_neighborhood_in);
+		if( t > maior ) maior = t;
+	}
+	ordem = (UINT*)mymalloc(sizeof(UINT) * 2 * n);
+	pos   = ordem + n;
+	chave = (uint64_t*)mymalloc(sizeof(uint64_t) * (n > maior ? n : maior));
+	visto = (bool*)mymalloc(sizeof(bool) * n);
+	memset(visto, 0, sizeof(bool) * n);
+	registra_auxiliar(g, (sizeof(UINT) * 2 + sizeof(bool)) * n
+		+ sizeof(uint64_t) * (n > maior ? n : maior));
+
+	// ordem[i] é o índice atual do i-ésimo vértice na nova ordem.
+	if( criterio == ORDEM_LARGURA ) {
+		for( i = 0, fim = 0; i < n; ++i )
+			if( !visto[i] )
+				largura_ordem(g, i, ordem, &fim, visto, FALSE, NULL);
+	} else {
+		for( i = 0; i < n; ++i )
+			chave[i] = (uint64_t)(criterio == ORDEM_GRAU ? ~grau_total(g, i) : grau_total(g, i)) << 32 | i;
+		qsort(chave, n, sizeof(uint64_t), compara_chaves);
+		for( i = 0; i < n; ++i )
+			ordem[i] = (UINT)chave[i];
+		if( criterio == ORDEM_CUTHILL_MCKEE ) {
+			// cada componente começa pelo vértice de menor grau; pos guarda
+			// a ordem por grau enquanto ordem recebe a busca.
+			memcpy(pos, ordem, sizeof(UINT) * n);
+			for( i = 0, fim = 0; i < n; ++i )
+				if( !visto[pos[i]] )
+					largura_ordem(g, pos[i], ordem, &fim, visto, TRUE, chave);
+			for( i = 0; i < n / 2; ++i ) {
+				UINT t = ordem[i];
+				ordem[i] = ordem[n - 1 - i];
+				ordem[n - 1 - i] = t;
+			}
+		}
+	}
+	for( i = 0; i < n; ++i )
+		pos[ordem[i]] = i;
+
+	// g_vertices e as vizinhanças na nova ordem (os nós são reaproveitados).
+	for( i = 0, nv = primeiro_no(g->g_vertices); nv; nv = proximo_no(nv) )
+		nv->conteudo = g->g_v[ordem[i++]];
+	for( i = 0; i < n; ++i ) {
+		ordena_lista(g, g->g_v[i], g->g_v[i]->v_neighborhood_out, pos, chave);
+		if( g->g_tipo )
+			ordena_lista(g, g->g_v[i], g->g_v[i]->v_neighborhood_in, pos, chave);
+	}
+
+	free(ordem);
+	free(chave);
+	free(visto);
+	destroi_csr(g);
+	garante_csr(g);
+
+	return 1;
+}
+
+/*
+ * Aqui termina a reordenacao dos vertices.
+ */
+
+//------------------------------------------------------------------------------
+// devolve a vizinhança do vértice v no grafo g
+//
+// se direcao == 0, v é um vértice de um grafo não direcionado
+//                  e a função devolve sua vizinhanca
+//
+// se direcao == -1, v é um vértice de um grafo direcionado e a função
+//                   devolve sua vizinhanca de entrada
+//
+// se direcao == 1, v é um vértice de um grafo direcionado e a função
+//                  devolve sua vizinhanca de saída
+lista vizinhanca(vertice v, int direcao, grafo g) {
+	UNUSED(g);
+    if( direcao == 0 )
+        return v->v_neighborhood_out;
+    else
+        return( direcao == -1 ? v->v_neighborhood_in : v->v_neighborhood_out );
+}
+
+//------------------------------------------------------------------------------
+struct vizinhos vizinhos_de(vertice v, int direcao, grafo g) {
+	const struct csr*	c;
+	struct vizinhos		s;
+
+	garante_csr(g);
+	c = direcao == -1 && g->g_tipo ? &g->g_in : &g->g_out;
+	s.vz_indice = c->c_viz + c->c_inicio[v->v_id];
+	s.vz_peso = c->c_peso + c->c_inicio[v->v_id];
+	s.vz_vertices = (vertice const*)g->g_v;
+	s.vz_n = c->c_inicio[v->v_id + 1] - c->c_inicio[v->v_id];
+	// a lista de um grafo não direcionado tem cada laço duas vezes; a CSR, uma.
+	s.vz_lacos = g->g_tipo ? 0 : tamanho_lista(v->v_neighborhood_out) - s.vz_n;
+
+	return s;
+}
+
+//------------------------------------------------------------------------------
+// devolve o grau do vértice v no grafo g
+//
+// se direcao == 0, v é um vértice de um grafo não direcionado
+//                  e a função devolve seu grau
+//
+// se direcao == -1, v é um vértice de um grafo direcionado
+//                   e a função devolve seu grau de entrada
+//
+// se direcao == 1, v é um vértice de um grafo direcionado
+//                  e a função devolve seu grau de saída
+unsigned int grau(vertice v, int direcao, grafo g) {
+    UNUSED(g);
+    if( direcao == 0 )
+        return tamanho_lista(v->v_neighborhood_out);
+    else
+        return( direcao == -1 ? tamanho_lista(v->v_neighborhood_in)\
+            : tamanho_lista(v->v_neighborhood_out) );
+}
+
+//------------------------------------------------------------------------------
+// devolve 1, se g é um grafo cordal ou
+//         0, caso contrário
+int cordal_r(grafo g, consulta q) {
+	lista l;
+	int r;
+
+	l = busca_largura_lexicografica_r(g, q);
+	r = ordem_perfeita_eliminacao_r(l, g, q);
+	destroi_lista(l, NULL);
+
+	return r;
+}
+
+//------------------------------------------------------------------------------
+int cordal(grafo g) {
+	struct consulta	q = { NULL, 0 };
+	int				r = cordal_r(g, &q);
+
+	free(q.c_vet);
+	return r;
+}
+
+//------------------------------------------------------------------------------
+// como cordal(), usando a ordem de busca_cardinalidade_maxima().
+int cordal_mcs_r(grafo g, consulta q) {
+	lista l;
+	int r;
+
+	l = busca_cardinalidade_maxima_r(g, q);
+	r = ordem_perfeita_eliminacao_r(l, g, q);
+	destroi_lista(l, NULL);
+
+	return r;
+}
+
+//------------------------------------------------------------------------------
+int cordal_mcs(grafo g) {
+	struct consulta	q = { NULL, 0 };
+	int				r = cordal_mcs_r(g, &q);
+
+	free(q.c_vet);
+	return r;
+}
+
+//------------------------------------------------------------------------------
+// devolve a clique C(v) de cliques_cordal(), usando marca[] com o valor m para
+// descartar arestas múltiplas.
+static lista clique_de(grafo g, UINT v, UINT* pos, UINT* marca, UINT m) {
+	lista	c = constroi_lista();
+	UINT	k, x;
+
+	for( k = g->g_out.c_inicio[v]; k < g->g_out.c_inicio[v+1]; ++k ) {
+		x = g->g_out.c_viz[k];
+		if( pos[x] <= pos[v] || marca[x] == m ) continue;
+		marca[x] = m;
+		insere_lista(g->g_v[x], c);
+	}
+	insere_lista(g->g_v[v], c);
+
+	return c;
+}
+
+//------------------------------------------------------------------------------
+// Cliques maximais de um grafo cordal, a partir da ordem perfeita de
+// eliminação dada pela busca em largura lexicográfica.
+//
+// Com os vértices na ordem de eliminação, todo vértice v forma com seus
+// vizinhos à direita, N+(v), uma clique C(v), e toda clique maximal é uma
+// dessas. C(v) não é maximal se e somente se algum u tem v como pai (o
+// primeiro vizinho à direita) e |N+(u)| = |N+(v)| + 1 (Fulkerson e Gross),
+// pois então C(v) está contida em C(u).
+//
+// Em tam[v] fica |N+(v)|, sem contar laços e arestas múltiplas; se todas
+// != NULL, a lista das cliques maximais é posta em *todas; se maxima !=
+// NULL, uma clique de tamanho máximo é posta em *maxima.
+//
+// devolve 1, ou 0 se g não é cordal (e nesse caso não constrói listas).
+static int cliques_cordal(grafo g, consulta q, lista* todas, lista* maxima) {
+	UINT	n = g->g_nvertices, i, k, v, x, melhor;
+	UINT	*pos, *ordem, *tam, *pai, *marca;
+	lista	l;
+	no		nv;
+
+	garante_csr(g);
+	l = busca_largura_lexicografica_r(g, q);
+	if( !ordem_perfeita_eliminacao_r(l, g, q) ) {
+		destroi_lista(l, NULL);
+		return 0;
+	}
+	if( todas ) *todas = constroi_lista();
+	if( maxima ) *maxima = constroi_lista();
+	if( !n ) {
+		destroi_lista(l, NULL);
+		return 1;
+	}
+
+	pos   = area_consulta(g, q, (size_t)5 * n);
+	ordem = pos + n;
+	tam   = ordem + n;
+	pai   = tam + n;
+	marca = pai + n;
+
+	for( i = 0, nv = primeiro_no(l); nv; ++i, nv = proximo_no(nv) ) {
+		v = ((vertice)conteudo(nv))->v_id;
+		pos[v] = i;
+		ordem[i] = v;
+		marca[v] = 0;
+	}
+	destroi_lista(l, NULL);
+
+	// tam[] e pai[]; marca[x] == i + 1 se x já foi contado para ordem[i].
+	for( i = 0, melhor = ordem[0]; i < n; ++i ) {
+		v = ordem[i];
+		tam[v] = 0;
+		pai[v] = NENHUM;
+		for( k = g->g_out.c_inicio[v]; k < g->g_out.c_inicio[v+1]; ++k ) {
+			x = g->g_out.c_viz[k];
+			if( pos[x] <= i || marca[x] == i + 1 ) continue;
+			marca[x] = i + 1;
+			++tam[v];
+			if( pai[v] == NENHUM || pos[x] < pos[pai[v]] )
+				pai[v] = x;
+		}
+		if( tam[v] > tam[melhor] )
+			melhor = v;
+	}
+
+	if( maxima ) {
+		destroi_lista(*maxima, NULL);
+		*maxima = clique_de(g, melhor, pos, marca, n + 1);
+	}
+	if( !todas )
+		return 1;
+
+	// marca[v] == NENHUM se C(v) não é maximal. As cliques são construídas
+	// da direita para a esquerda, de forma que clique_de() só remarca
+	// vértices já examinados.
+	for( i = 0; i < n; ++i ) {
+		v = ordem[i];
+		if( pai[v] != NENHUM && tam[v] == tam[pai[v]] + 1 )
+			marca[pai[v]] = NENHUM;
+	}
+	for( i = n; i-- > 0; ) {
+		v = ordem[i];
+		if( marca[v] != NENHUM )
+			insere_lista(clique_de(g, v, pos, marca, n + 2 + i), *todas);
+	}
+
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+lista cliques_maximais(grafo g) {
+	struct consulta	q = { NULL, 0 };
+	lista			l = NULL;
+
+	cliques_cordal(g, &q, &l, NULL);
+	free(q.c_vet);
+	return l;
+}
+
+//------------------------------------------------------------------------------
+lista clique_maxima(grafo g) {
+	struct consulta	q = { NULL, 0 };
+	lista			l = NULL;
+
+	cliques_cordal(g, &q, NULL, &l);
+	free(q.c_vet);
+	return l;
+}
+
+//------------------------------------------------------------------------------
+int destroi_clique(void* c) {
+	return destroi_lista(c, NULL);
+}
+
+//------------------------------------------------------------------------------
+// devolve um contexto de consulta para g.
+consulta constroi_consulta(grafo g) {
+	consulta q;
+
+	garante_csr(g);
+	q = (consulta)mymalloc(sizeof(struct consulta));
+	q->c_tam = (size_t)8 * (g->g_nvertices ? g->g_nvertices : 1);
+	q->c_vet = (UINT*)mymalloc(sizeof(UINT) * q->c_tam);
+
+	return q;
+}
+
+//------------------------------------------------------------------------------
+void destroi_consulta(consulta q) {
+	if( !q ) return;
+	free(q->c_vet);
+	free(q);
+}
+
+//------------------------------------------------------------------------------
+// devolve a área de trabalho de q com pelo menos tam UINTs.
+static UINT* area_consulta(grafo g, consulta q, size_t tam) {
+	registra_auxiliar(g, sizeof(UINT) * tam);
+	if( tam > q->c_tam ) {
+		free(q->c_vet);
+		q->c_vet = (UINT*)mymalloc(sizeof(UINT) * tam);
+		q->c_tam = tam;
+	}
+
+	return q->c_vet;
+}
+
+//------------------------------------------------------------------------------
+// desaloca toda a memória usada em *g
+//
+// devolve 1 em caso de sucesso ou
+//         0 caso contrário
+//
+// g é um (void *) para que destroi_grafo() possa ser usada como argumento de
+// destroi_lista()
+int destroi_grafo(void *c) {
+	grafo g = (grafo)c;
+
+	// vértices, nomes, arestas e listas estão todos na arena.
+	destroi_csr(g);
+	destroi_indice(g);
+	libera_arena(&g->g_arena);
+	libera_entrada(&g->g_mapa);
+	free(c);
+	c = NULL;
+
+	return 1;
+}
+
+/*****
+ * Functions helpers.
+ *
+ ******************************************************************/
+//------------------------------------------------------------------------------
+int busca_aresta(lista l, aresta a) {
+	no n;
+	aresta p;
+	int found = FALSE;
+
+	for( n=primeiro_no(l); n && !found; n=proximo_no(n) ) {
+		p = (aresta)conteudo(n);
+		found = ( p->a_orig == a->a_dst &&\
+				  p->a_dst  == a->a_orig );
+	}
+
+	return found;
+}
+
+//------------------------------------------------------------------------------
+void* mymalloc(size_t size) {
+	void* p;
+
+	if( !(p = malloc(size)) ) {
+		perror("Could not allocate memory!");
+        exit(EXIT_FAILURE);
+	}
+	CONTA(e_alocacoes, 1);
+	CONTA(e_bytes_alocados, size);
+
+	return p;
+}
+
+//------------------------------------------------------------------------------
+// como mymalloc(), para realloc(); conta size bytes alocados.
+void* myrealloc(void* p, size_t size) {
+
+	if( !(p = realloc(p, size)) ) {
+		perror("Could not allocate memory!");
+        exit(EXIT_FAILURE);
+	}
+	CONTA(e_alocacoes, 1);
+	CONTA(e_bytes_alocados, size);
+
+	return p;
+}
+
+//------------------------------------------------------------------------------
+// Le todas as arestas the um grado não direcionado.
+static void BuildListOfEdges(grafo g, Agraph_t* Ag_g, Agnode_t* Ag_v, const char* head_name) {
+	UNUSED(head_name);
+	Agedge_t* 	Ag_e;
+	char*		weight;
+	char		str_weight[5] = "peso";
+	vertice		head, tail;
+
+	for( Ag_e=agfstedge(Ag_g, Ag_v); Ag_e; Ag_e=agnxtedge(Ag_g, Ag_e, Ag_v) ) {
+		if( agtail(Ag_e) == Ag_v ) {
+			weight = agget(Ag_e, str_weight);
+			if( weight )
+				g->g_ponderado = TRUE;
+			tail = busca_vertice_nome(agnameof(agtail(Ag_e)), g);
+			head = busca_vertice_nome(agnameof(aghead(Ag_e)), g);
+			nova_aresta(g, tail, head, weight ? atol(weight) : 0, weight != NULL);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Le todas os arcos de um grafo direcionato.
+static void BuildListOfArrows(grafo g, Agraph_t* Ag_g, Agnode_t* Ag_v, const char* head_name) {
+	UNUSED(head_name);
+	Agedge_t* 	Ag_e;
+	char*		weight;
+	char		str_weight[5] = "peso";
+	vertice		head, tail;
+
+	for( Ag_e=agfstout(Ag_g, Ag_v); Ag_e; Ag_e=agnxtout(Ag_g, Ag_e) ) {
+		if( agtail(Ag_e) == Ag_v ) {
+			weight = agget(Ag_e, str_weight);
+			if( weight )
+				g->g_ponderado = TRUE;
+			tail = busca_vertice_nome(agnameof(agtail(Ag_e)), g);
+			head = busca_vertice_nome(agnameof(aghead(Ag_e)), g);
+			nova_aresta(g, tail, head, weight ? atol(weight) : 0, weight != NULL);
+		}
+	}
+}
+
+/*________________________________________________________________*/
+/*
+ * Aqui comeca o leitor de dot.
+ *
+ * Leitor de uma passada para o subconjunto de dot que usamos:
+ *
+ *     [strict] (graph|digraph) ID { (ID | ID (--|->) ID ... [attrs] | ID=ID) [;] ... }
+ *
+ * onde ID é um identificador, um número ou uma string entre aspas. Dos
+ * atributos, somente "peso" de arestas é considerado. Qualquer outra
+ * construção (subgrafos, portas, atributos default, html, ...) faz o leitor
+ * desistir e le_grafo() recorre à libcgraph.
+ */
+
+typedef enum __token {
+	tFim = 0,
+	tId,
+	tAbre,			// {
+	tFecha,			// }
+	tAbreAtr,		// [
+	tFechaAtr,		// ]
+	tIgual,			// =
+	tSep,			// ; ou ,
+	tAresta,		// -- ou ->
+	tOutro			// qualquer coisa que o leitor não trata
+}eToken;
+
+// aresta lida, antes de ser inserida no grafo.
+struct aresta_lida {
+	UINT	al_cauda;		// índice (ordem de criação) da cauda.
+	UINT	al_cabeca;		// índice (ordem de criação) da cabeça.
+	LINT	al_peso;
+};
+
+struct leitor {
+	const char*	l_p;			// posição atual.
+	const char*	l_fim;
+	char*		l_tok;			// texto do último tId.
+	size_t		l_cap_tok;
+	bool		l_aspas;		// o último tId estava entre aspas?
+	bool		l_strict;
+	grafo		l_g;
+	vertice*	l_v;			// vértices em ordem de criação.
+	UINT		l_nv, l_cap_v;
+	struct aresta_lida* l_a;	// arestas em ordem de criação.
+	UINT		l_na, l_cap_a;
+	UINT*		l_conj;			// hash (cauda, cabeça) -> aresta, se strict.
+	UINT		l_mascara;
+	UINT		l_ncmd;
+	UINT*		l_cmd;			// arestas do comando sendo lido.
+	UINT		l_cap_cmd;
+	UINT		padding;
+};
+
+static void guarda_char(struct leitor* l, size_t i, char c) {
+	if( i + 1 >= l->l_cap_tok ) {
+		l->l_cap_tok = l->l_cap_tok ? 2 * l->l_cap_tok : 64;
+		l->l_tok = (char*)myrealloc(l->l_tok, l->l_cap_tok);
+	}
+	l->l_tok[i] = c;
+}
+
+static bool letra_dot(char c) {
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || (c & 0x80);
+}
+
+static bool digito_dot(char c) {
+	return c >= '0' && c <= '9';
+}
+
+//------------------------------------------------------------------------------
+// Pula brancos e comentários (//, /* */ e linhas começadas por #).
+static void pula_brancos(struct leitor* l, const char* inicio) {
+	const char* p = l->l_p;
+
+	while( p < l->l_fim ) {
+		if( *p == ' ' || *p == '\t' || *p == '\n' || *p == '\r' || *p == '\f' || *p == '\v' )
+			++p;
+		else if( *p == '#' && (p == inicio || p[-1] == '\n') )
+			while( p < l->l_fim && *p != '\n' ) ++p;
+		else if( *p == '/' && p + 1 < l->l_fim && p[1] == '/' )
+			while( p < l->l_fim && *p != '\n' ) ++p;
+		else if( *p == '/' && p + 1 < l->l_fim && p[1] == '*' ) {
+			for( p += 2; p + 1 < l->l_fim && !(p[0] == '*' && p[1] == '/'); ++p );
+			p = p + 1 < l->l_fim ? p + 2 : l->l_fim;
+		}
+		else break;
+	}
+	l->l_p = p;
+}
+
+//------------------------------------------------------------------------------
+// Lê o próximo token; se for tId seu texto fica em l->l_tok.
+static eToken proximo_token(struct leitor* l, const char* inicio) {
+	const char*	p;
+	size_t		i = 0;
+
+	pula_brancos(l, inicio);
+	p = l->l_p;
+	if( p >= l->l_fim ) return tFim;
+
+	l->l_aspas = FALSE;
+	switch( *p ) {
+	case '{': l->l_p++; return tAbre;
+	case '}': l->l_p++; return tFecha;
+	case '[': l->l_p++; return tAbreAtr;
+	case ']': l->l_p++; return tFechaAtr;
+	case '=': l->l_p++; return tIgual;
+	case ';': case ',': l->l_p++; return tSep;
+	case '"':
+		for( ++p; p < l->l_fim && *p != '"'; ++p ) {
+			if( *p == '\\' && p + 1 < l->l_fim ) {
+				if( p[1] == '"' ) { guarda_char(l, i++, '"'); ++p; continue; }
+				if( p[1] == '\n' ) { ++p; continue; }
+				if( p[1] == '\r' && p + 2 < l->l_fim && p[2] == '\n' ) { p += 2; continue; }
+			}
+			guarda_char(l, i++, *p);
+		}
+		if( p >= l->l_fim ) return tOutro;
+		l->l_p = p + 1;
+		// concatenação com + não é tratada.
+		pula_brancos(l, inicio);
+		if( l->l_p < l->l_fim && *l->l_p == '+' ) return tOutro;
+		guarda_char(l, i, '\0');
+		l->l_aspas = TRUE;
+		return tId;
+	case '-':
+		if( p + 1 < l->l_fim && (p[1] == '-' || p[1] == '>') ) {
+			l->l_p += 2;
+			return tAresta;
+		}
+		break;
+	default:
+		break;
+	}
+
+	if( letra_dot(*p) ) {
+		for( ; p < l->l_fim && (letra_dot(*p) || digito_dot(*p)); ++p )
+			guarda_char(l, i++, *p);
+	} else if( *p == '-' || *p == '.' || digito_dot(*p) ) {
+		if( *p == '-' ) guarda_char(l, i++, *p++);
+		for( ; p < l->l_fim && digito_dot(*p); ++p ) guarda_char(l, i++, *p);
+		if( p < l->l_fim && *p == '.' )
+			for( guarda_char(l, i++, *p++); p < l->l_fim && digito_dot(*p); ++p )
+				guarda_char(l, i++, *p);
+		// número mal delimitado ("1a", "-", ".") fica para a libcgraph.
+		if( i == 0 || (i == 1 && (l->l_tok[0] == '-' || l->l_tok[0] == '.')) ||
+			(p < l->l_fim && (letra_dot(*p) || *p == '.')) )
+			return tOutro;
+	} else
+		return tOutro;
+
+	guarda_char(l, i, '\0');
+	l->l_p = p;
+	return tId;
+}
+
+//------------------------------------------------------------------------------
+// devolve 1 se o último token é a palavra reservada kw (sem distinção de caixa).
+static bool palavra(struct leitor* l, const char* kw) {
+	const char* t = l->l_tok;
+
+	if( l->l_aspas ) return FALSE;
+	for( ; *t && *kw; ++t, ++kw )
+		if( (*t | 0x20) != *kw ) return FALSE;
+
+	return *t == *kw;
+}
+
+//------------------------------------------------------------------------------
+// Cria um grafo vazio de nome nome (NULL se o nome é atribuído depois).
+grafo novo_grafo(const char* nome, int tipo) {
+	grafo g;
+
+	g = (grafo)mymalloc(sizeof(struct grafo));
+	memset(g, 0, sizeof(struct grafo));
+	g->g_tipo = tipo;
+	g->g_nome = nome ? strdup_arena(&g->g_arena, nome) : NULL;
+	g->g_vertices = constroi_lista_arena(&g->g_arena);
+
+	return g;
+}
+
+//------------------------------------------------------------------------------
+// Cria um vértice de nome nome em g (sem rótulo) e o insere no índice.
+vertice novo_vertice(grafo g, const char* nome) {
+	vertice v;
+
+	v = (vertice)aloca_arena(&g->g_arena, sizeof(struct vertice));
+	memset(v, 0, sizeof(struct vertice));
+	v->v_nome = strdup_arena(&g->g_arena, nome);
+	v->v_neighborhood_in = constroi_lista_arena(&g->g_arena);
+	v->v_neighborhood_out = constroi_lista_arena(&g->g_arena);
+	// Insert vertex to the list of vertexes in the graph list.
+	if( !insere_lista(v, g->g_vertices) ) exit(EXIT_FAILURE);
+	insere_indice(g, v);
+
+	return v;
+}
+
+//------------------------------------------------------------------------------
+// Cria a aresta (ou arco) tail -> head em g e a insere nas vizinhanças.
+aresta nova_aresta(grafo g, vertice tail, vertice head, LINT peso, bool ponderada) {
+	aresta a;
+
+	if( (a = g->g_arena.a_arestas) != NULL )
+		g->g_arena.a_arestas = (aresta)(void*)a->a_dst;
+	else
+		a = (aresta)aloca_arena(&g->g_arena, sizeof(struct aresta));
+	memset(a, 0, sizeof(struct aresta));
+	a->a_peso = peso;
+	a->a_ponderado = ponderada;
+	a->a_orig = tail;
+	a->a_dst  = head;
+	if( g->g_tipo ) {
+		if( !insere_lista(a, head->v_neighborhood_in ) ) exit(EXIT_FAILURE);
+	} else {
+		if( !insere_lista(a, head->v_neighborhood_out ) ) exit(EXIT_FAILURE);
+	}
+	if( !insere_lista(a, tail->v_neighborhood_out ) ) exit(EXIT_FAILURE);
 
-    ret = clique(l, g);
-    destroi_lista(l, NULL);
+	return a;
+}
+
+//------------------------------------------------------------------------------
+// devolve o vértice de nome l->l_tok, criando-o se não existir.
+static vertice vertice_lido(struct leitor* l) {
+	vertice v = busca_vertice_nome(l->l_tok, l->l_g);
+
+	if( v ) return v;
+	v = novo_vertice(l->l_g, l->l_tok);
+	if( l->l_nv == l->l_cap_v ) {
+		l->l_cap_v = l->l_cap_v ? 2 * l->l_cap_v : 64;
+		l->l_v = (vertice*)myrealloc(l->l_v, sizeof(vertice) * l->l_cap_v);
+	}
+	v->v_id = l->l_nv;
+	l->l_v[l->l_nv++] = v;
 
-    return ret;
+	return v;
 }
 
 //------------------------------------------------------------------------------
-// devolve a vizinhança do vértice v no grafo g
-//
-// se direcao == 0, v é um vértice de um grafo não direcionado
-//                  e a função devolve sua vizinhanca
-//
-// se direcao == -1, v é um vértice de um grafo direcionado e a função
-//                   devolve sua vizinhanca de entrada
-//
-// se direcao == 1, v é um vértice de um grafo direcionado e a função
-//                  devolve sua vizinhanca de saída
-lista vizinhanca(vertice v, int direcao, grafo g) {
-	UNUSED(g);
-    if( direcao == 0 )
-        return v->v_neighborhood_out;
-    else
-        return( direcao == -1 ? v->v_neighborhood_in : v->v_neighborhood_out );
+// Acrescenta a aresta t -> h às arestas do comando sendo lido. Num grafo
+// strict uma aresta repetida é a mesma aresta.
+static void aresta_lida(struct leitor* l, vertice t, vertice h) {
+	UINT	a, b, i, k, cap;
+	UINT*	conj;
+
+	if( l->l_ncmd == l->l_cap_cmd ) {
+		l->l_cap_cmd = l->l_cap_cmd ? 2 * l->l_cap_cmd : 16;
+		l->l_cmd = (UINT*)myrealloc(l->l_cmd, sizeof(UINT) * l->l_cap_cmd);
+	}
+
+	if( l->l_strict ) {
+		a = t->v_id; b = h->v_id;
+		if( !l->l_g->g_tipo && a > b ) { k = a; a = b; b = k; }
+		for( i = (a * 2654435761u ^ b) & l->l_mascara; (k = l->l_conj[i]) != NENHUM; i = (i + 1) & l->l_mascara ) {
+			UINT ka = l->l_a[k].al_cauda, kb = l->l_a[k].al_cabeca;
+			if( !l->l_g->g_tipo && ka > kb ) { UINT x = ka; ka = kb; kb = x; }
+			if( ka == a && kb == b ) {
+				l->l_cmd[l->l_ncmd++] = k;
+				return;
+			}
+		}
+	}
+
+	if( l->l_na == l->l_cap_a ) {
+		l->l_cap_a = l->l_cap_a ? 2 * l->l_cap_a : 64;
+		l->l_a = (struct aresta_lida*)myrealloc(l->l_a, sizeof(struct aresta_lida) * l->l_cap_a);
+	}
+	l->l_a[l->l_na].al_cauda = t->v_id;
+	l->l_a[l->l_na].al_cabeca = h->v_id;
+	l->l_a[l->l_na].al_peso = 0;
+	l->l_cmd[l->l_ncmd++] = l->l_na++;
+
+	if( !l->l_strict ) return;
+	if( 2 * l->l_na > l->l_mascara + 1 ) {
+		cap = 2 * (l->l_mascara + 1);
+		conj = (UINT*)mymalloc(sizeof(UINT) * cap);
+		memset(conj, 0xff, sizeof(UINT) * cap);
+		free(l->l_conj);
+		l->l_conj = conj;
+		l->l_mascara = cap - 1;
+		k = 0;
+	} else
+		k = l->l_na - 1;
+	// (re)insere as arestas a partir de k.
+	for( ; k < l->l_na; ++k ) {
+		a = l->l_a[k].al_cauda; b = l->l_a[k].al_cabeca;
+		if( !l->l_g->g_tipo && a > b ) { i = a; a = b; b = i; }
+		for( i = (a * 2654435761u ^ b) & l->l_mascara; l->l_conj[i] != NENHUM; i = (i + 1) & l->l_mascara );
+		l->l_conj[i] = k;
+	}
 }
 
 //------------------------------------------------------------------------------
-// devolve o grau do vértice v no grafo g
-//
-// se direcao == 0, v é um vértice de um grafo não direcionado
-//                  e a função devolve seu grau
+// Lê uma lista de atributos ([a=b, ...] [..]) já tendo consumido o primeiro
+// '['. Guarda o valor de "peso", se houver, em *peso.
 //
-// se direcao == -1, v é um vértice de um grafo direcionado
-//                   e a função devolve seu grau de entrada
-//
-// se direcao == 1, v é um vértice de um grafo direcionado
-//                  e a função devolve seu grau de saída
-unsigned int grau(vertice v, int direcao, grafo g) {
-    UNUSED(g);
-    if( direcao == 0 )
-        return tamanho_lista(v->v_neighborhood_out);
-    else
-        return( direcao == -1 ? tamanho_lista(v->v_neighborhood_in)\
-            : tamanho_lista(v->v_neighborhood_out) );
+// devolve o token seguinte à lista, ou tOutro em caso de erro.
+static eToken le_atributos(struct leitor* l, const char* inicio, LINT* peso, bool* tem_peso) {
+	eToken	t;
+	bool	eh_peso;
+
+	for( ;; ) {
+		t = proximo_token(l, inicio);
+		if( t == tFechaAtr ) {
+			t = proximo_token(l, inicio);
+			if( t != tAbreAtr ) return t;
+			continue;
+		}
+		if( t == tSep ) continue;
+		if( t != tId ) return tOutro;
+		eh_peso = strcmp(l->l_tok, "peso") == 0;
+		if( proximo_token(l, inicio) != tIgual ) return tOutro;
+		if( proximo_token(l, inicio) != tId ) return tOutro;
+		if( eh_peso ) {
+			*peso = atol(l->l_tok);
+			*tem_peso = TRUE;
+		}
+	}
 }
 
 //------------------------------------------------------------------------------
-// devolve 1, se g é um grafo cordal ou
-//         0, caso contrário
-int cordal(grafo g) {
-	lista l;
-	int r;
-
-	l = busca_largura_lexicografica(g);
-	r = ordem_perfeita_eliminacao(l, g);
-	destroi_lista(l, NULL);
+// Insere em g as arestas lidas, agrupadas pela cauda na ordem de criação dos
+// vértices, na mesma ordem em que a leitura pela libcgraph as insere.
+static void insere_arestas_lidas(struct leitor* l) {
+	grafo	g = l->l_g;
+	UINT*	inicio;
+	UINT*	ordem;
+	UINT	i;
+
+	inicio = (UINT*)mymalloc(sizeof(UINT) * (l->l_nv + 1));
+	ordem = (UINT*)mymalloc(sizeof(UINT) * (l->l_na ? l->l_na : 1));
+	memset(inicio, 0, sizeof(UINT) * (l->l_nv + 1));
+	for( i = 0; i < l->l_na; ++i )
+		inicio[l->l_a[i].al_cauda + 1]++;
+	for( i = 0; i < l->l_nv; ++i )
+		inicio[i+1] += inicio[i];
+	for( i = 0; i < l->l_na; ++i )
+		ordem[inicio[l->l_a[i].al_cauda]++] = i;
+
+	for( i = 0; i < l->l_na; ++i ) {
+		struct aresta_lida* al = &l->l_a[ordem[i]];
+		nova_aresta(g, l->l_v[al->al_cauda], l->l_v[al->al_cabeca], al->al_peso, g->g_ponderado);
+	}
 
-	return r;
+	free(inicio);
+	free(ordem);
 }
 
 //------------------------------------------------------------------------------
-// desaloca toda a memória usada em *g
-//
-// devolve 1 em caso de sucesso ou
-//         0 caso contrário
+// Lê um grafo do texto [buf, buf+tam).
 //
-// g é um (void *) para que destroi_grafo() possa ser usada como argumento de
-// destroi_lista()
-int destroi_grafo(void *c) {
-	grafo g = (grafo)c;
-	int ret;
-	
-	free(g->g_nome);
-	g->g_nome = NULL;
-	ret = destroi_lista(g->g_vertices, destroi_vertice);
-	g->g_vertices = NULL;
-	free(c);
-	c = NULL;
+// devolve o grafo lido, com o número de bytes consumidos em *usado, ou
+//         NULL se o texto não está no subconjunto tratado (ou tem erro).
+static grafo le_grafo_dot(const char* buf, size_t tam, size_t* usado) {
+	struct leitor	l;
+	eToken			t;
+	vertice			v, w;
+	UINT			i;
+	LINT			peso;
+	bool			tem_peso, ok = FALSE;
+
+	memset(&l, 0, sizeof(struct leitor));
+	l.l_p = buf;
+	l.l_fim = buf + tam;
+
+	t = proximo_token(&l, buf);
+	if( t == tId && palavra(&l, "strict") ) {
+		l.l_strict = TRUE;
+		t = proximo_token(&l, buf);
+	}
+	if( t != tId || !(palavra(&l, "graph") || palavra(&l, "digraph")) ) goto fim;
+
+	l.l_g = novo_grafo(NULL, palavra(&l, "digraph"));
+	// grafo anônimo fica para a libcgraph, que lhe dá um nome.
+	if( proximo_token(&l, buf) != tId ) goto fim;
+	l.l_g->g_nome = strdup_arena(&l.l_g->g_arena, l.l_tok);
+	if( proximo_token(&l, buf) != tAbre ) goto fim;
+	if( l.l_strict ) {
+		l.l_conj = (UINT*)mymalloc(sizeof(UINT) * 64);
+		memset(l.l_conj, 0xff, sizeof(UINT) * 64);
+		l.l_mascara = 63;
+	}
 
-	return ret;
+	t = proximo_token(&l, buf);
+	while( t != tFecha ) {
+		if( t == tSep ) { t = proximo_token(&l, buf); continue; }
+		if( t != tId ) goto fim;
+		if( palavra(&l, "node") || palavra(&l, "edge") || palavra(&l, "graph") ||
+			palavra(&l, "subgraph") || palavra(&l, "strict") || palavra(&l, "digraph") )
+			goto fim;
+
+		// ID = ID é um atributo do grafo, que é desconsiderado.
+		pula_brancos(&l, buf);
+		if( l.l_p < l.l_fim && *l.l_p == '=' ) {
+			l.l_p++;
+			if( proximo_token(&l, buf) != tId ) goto fim;
+			t = proximo_token(&l, buf);
+			continue;
+		}
+		v = vertice_lido(&l);
+		l.l_ncmd = 0;
+		while( (t = proximo_token(&l, buf)) == tAresta ) {
+			if( (l.l_p[-1] == '>') != (l.l_g->g_tipo != 0) ) goto fim;
+			if( proximo_token(&l, buf) != tId ) goto fim;
+			w = vertice_lido(&l);
+			aresta_lida(&l, v, w);
+			v = w;
+		}
+		if( t == tAbreAtr ) {
+			tem_peso = FALSE;
+			peso = 0;
+			t = le_atributos(&l, buf, &peso, &tem_peso);
+			if( t == tOutro ) goto fim;
+			if( tem_peso && l.l_ncmd ) {
+				l.l_g->g_ponderado = TRUE;
+				for( i = 0; i < l.l_ncmd; ++i )
+					l.l_a[l.l_cmd[i]].al_peso = peso;
+			}
+		}
+		if( t == tOutro || t == tFim || t == tAbre ) goto fim;
+	}
+	*usado = (size_t)(l.l_p - buf);
+
+	insere_arestas_lidas(&l);
+	constroi_csr(l.l_g);
+	ok = TRUE;
+
+fim:
+	if( !ok && l.l_g ) {
+		destroi_grafo(l.l_g);
+		l.l_g = NULL;
+	}
+	free(l.l_tok);
+	free(l.l_v);
+	free(l.l_a);
+	free(l.l_conj);
+	free(l.l_cmd);
+
+	return l.l_g;
 }
 
-/*****
- * Functions helpers.
+/*
+ * Aqui termina o leitor de dot.
+ */
+
+/*________________________________________________________________*/
+/*
+ * Aqui comeca o formato binario.
  *
- ******************************************************************/
-int destroi_vertice(void* c) {
-	int ret;
-	vertice v = (vertice)c;
-
-	free(v->v_nome);
-	v->v_nome = NULL;
-	free(v->v_lbl);
-	v->v_lbl = NULL;
-	ret = destroi_lista(v->v_neighborhood_in, destroi_aresta) && \
-		  destroi_lista(v->v_neighborhood_out, destroi_aresta);
-	v->v_neighborhood_in = v->v_neighborhood_out = NULL;
-	free(c);
-	c = NULL;
+ * Um snapshot é o cabeçalho seguido de seções alinhadas em 8 bytes:
+ *
+ *     LINT  peso[m]                          pesos das arestas
+ *     LINT  out.c_peso[k_out], in.c_peso[k_in]
+ *     UINT  nome[n]                          deslocamento do nome no pool
+ *     UINT  orig[m], dst[m]                  extremos das arestas
+ *     UINT  out.c_inicio[n+1], out.c_viz[k_out], out.c_aresta[k_out]
+ *     UINT  in.c_inicio[n+1], in.c_viz[k_in], in.c_aresta[k_in]  (direcionado)
+ *     char  pool[]                           nome do grafo e dos vértices
+ *
+ * Os números estão na ordem de bytes da máquina que gravou; um snapshot de
+ * outra arquitetura é recusado pela versão. A carga mapeia o arquivo e usa
+ * a CSR, os pesos e os nomes diretamente do mapeamento.
+ */
 
-	return ret;
+#define BIN_VERSAO		1u
+#define BIN_DIRECIONADO	0x1u
+#define BIN_PONDERADO	0x2u
+#define BIN_ALINHA(x)	(((x) + 7) & ~(uint64_t)7)
+
+struct cabecalho_bin {
+	char		b_magica[8];		// "GRAFOBIN"
+	UINT		b_versao;
+	UINT		b_flags;
+	UINT		b_nvertices;
+	UINT		b_narestas;
+	UINT		b_nviz_out;			// posições na CSR de saída.
+	UINT		b_nviz_in;			// posições na CSR de entrada.
+	uint64_t	b_tam_pool;
+	uint64_t	b_tam;				// tamanho total do snapshot.
+};
+
+static const char bin_magica[8] = { 'G', 'R', 'A', 'F', 'O', 'B', 'I', 'N' };
+
+//------------------------------------------------------------------------------
+// Tamanho total de um snapshot com essas dimensões, ou UINT64_MAX se ele não
+// cabe em 64 bits (pool vem do cabeçalho e não é confiável). As demais seções
+// somam menos de 2^40 bytes, pois as dimensões são de 32 bits.
+static uint64_t tam_binario(UINT n, UINT m, UINT kout, UINT kin, bool dir, uint64_t pool) {
+	uint64_t un = n, um = m, ko = kout, ki = kin, fixo;
+
+	fixo = sizeof(struct cabecalho_bin)
+		+ BIN_ALINHA(sizeof(LINT) * um) + BIN_ALINHA(sizeof(LINT) * (ko + ki))
+		+ BIN_ALINHA(sizeof(UINT) * un) + 2 * BIN_ALINHA(sizeof(UINT) * um)
+		+ BIN_ALINHA(sizeof(UINT) * (un + 1)) + 2 * BIN_ALINHA(sizeof(UINT) * ko)
+		+ (dir ? BIN_ALINHA(sizeof(UINT) * (un + 1)) + 2 * BIN_ALINHA(sizeof(UINT) * ki) : 0);
+	if( pool > UINT64_MAX - 7 - fixo )
+		return UINT64_MAX;
+
+	return fixo + BIN_ALINHA(pool);
 }
 
-int destroi_aresta(void* c) {
-	aresta a = (aresta)c;
+//------------------------------------------------------------------------------
+// Como le_entrada(), mas de input que não pode ser mapeado lê só um snapshot:
+// o cabeçalho e os b_tam bytes que ele anuncia, deixando o resto em input.
+// O buffer cresce com o que é de fato lido, e não com o b_tam do cabeçalho,
+// que não é confiável.
+static bool le_entrada_binario(FILE* input, struct entrada* e) {
+	struct cabecalho_bin	c;
+	size_t	cap, n, k;
+
+	if( mapeia_entrada(input, e) )
+		return TRUE;
+	if( fread(&c, 1, sizeof(struct cabecalho_bin), input) != sizeof(struct cabecalho_bin) ||
+		c.b_tam < sizeof(struct cabecalho_bin) || c.b_tam > SIZE_MAX )
+		return FALSE;
+
+	cap = c.b_tam < (1 << 16) ? (size_t)c.b_tam : 1 << 16;
+	e->e_buf = (char*)mymalloc(cap);
+	memcpy(e->e_buf, &c, sizeof(struct cabecalho_bin));
+	for( n = sizeof(struct cabecalho_bin); n < c.b_tam; n += k ) {
+		if( n == cap ) {
+			cap = c.b_tam / 2 > cap ? 2 * cap : (size_t)c.b_tam;
+			e->e_buf = (char*)myrealloc(e->e_buf, cap);
+		}
+		if( !(k = fread(e->e_buf + n, 1, cap - n, input)) )
+			break;
+	}
+	e->e_tam = n;
 
-	if( a->a_dst )
-		free(c);
-	a->a_dst = a->a_orig = NULL;
-	c = NULL;
+	return !ferror(input);
+}
 
-	return 1;
+//------------------------------------------------------------------------------
+// Escreve tam bytes de p e completa com zeros até múltiplo de 8.
+static bool grava_secao(FILE* output, const void* p, size_t tam) {
+	static const char zeros[8] = { 0 };
+
+	if( tam && fwrite(p, 1, tam, output) != tam ) return FALSE;
+	tam = BIN_ALINHA(tam) - tam;
+
+	return !tam || fwrite(zeros, 1, tam, output) == tam;
 }
 
 //------------------------------------------------------------------------------
-int busca_aresta(lista l, aresta a) {
-	no n;
-	aresta p;
-	int found = FALSE;
+// escreve g em output no formato binário
+//
+// devolve o grafo escrito ou
+//         NULL em caso de erro
+grafo grava_grafo_binario(FILE *output, grafo g) {
+	struct cabecalho_bin	c;
+	UINT		n, m, kout, kin, i;
+	UINT*		u;
+	LINT*		p;
+	size_t		tam, pos;
+	bool		ok;
+
+	if( !g ) return NULL;
+	INICIO(t0);
+	garante_csr(g);
+	n = g->g_nvertices;
+	m = g->g_naresta;
+	kout = g->g_out.c_inicio[n];
+	kin = g->g_tipo ? g->g_in.c_inicio[n] : 0;
+
+	memset(&c, 0, sizeof(struct cabecalho_bin));
+	memcpy(c.b_magica, bin_magica, sizeof(bin_magica));
+	c.b_versao = BIN_VERSAO;
+	c.b_flags = (g->g_tipo ? BIN_DIRECIONADO : 0) | (g->g_ponderado ? BIN_PONDERADO : 0);
+	c.b_nvertices = n;
+	c.b_narestas = m;
+	c.b_nviz_out = kout;
+	c.b_nviz_in = kin;
+	c.b_tam_pool = strlen(g->g_nome) + 1;
+	for( i = 0; i < n; ++i )
+		c.b_tam_pool += strlen(g->g_v[i]->v_nome) + 1;
+	c.b_tam = tam_binario(n, m, kout, kin, g->g_tipo != 0, c.b_tam_pool);
+
+	// vetor auxiliar grande o bastante para qualquer das seções por aresta/vértice.
+	tam = (m > n ? m : n) + 1;
+	u = (UINT*)mymalloc(sizeof(UINT) * tam);
+	p = (LINT*)mymalloc(sizeof(LINT) * (m ? m : 1));
+
+	ok = grava_secao(output, &c, sizeof(struct cabecalho_bin));
+	for( i = 0; i < m; ++i ) p[i] = g->g_a[i]->a_peso;
+	ok = ok && grava_secao(output, p, sizeof(LINT) * m);
+	if( ok && kout ) ok = fwrite(g->g_out.c_peso, sizeof(LINT), kout, output) == kout;
+	if( ok && kin ) ok = fwrite(g->g_in.c_peso, sizeof(LINT), kin, output) == kin;
+	ok = ok && grava_secao(output, NULL, 0);
+
+	pos = strlen(g->g_nome) + 1;
+	for( i = 0; i < n; ++i ) {
+		u[i] = (UINT)pos;
+		pos += strlen(g->g_v[i]->v_nome) + 1;
+	}
+	ok = ok && grava_secao(output, u, sizeof(UINT) * n);
+	for( i = 0; i < m; ++i ) u[i] = g->g_a[i]->a_orig->v_id;
+	ok = ok && grava_secao(output, u, sizeof(UINT) * m);
+	for( i = 0; i < m; ++i ) u[i] = g->g_a[i]->a_dst->v_id;
+	ok = ok && grava_secao(output, u, sizeof(UINT) * m);
+
+	ok = ok && grava_secao(output, g->g_out.c_inicio, sizeof(UINT) * (n + 1));
+	ok = ok && grava_secao(output, g->g_out.c_viz, sizeof(UINT) * kout);
+	ok = ok && grava_secao(output, g->g_out.c_aresta, sizeof(UINT) * kout);
+	if( g->g_tipo ) {
+		ok = ok && grava_secao(output, g->g_in.c_inicio, sizeof(UINT) * (n + 1));
+		ok = ok && grava_secao(output, g->g_in.c_viz, sizeof(UINT) * kin);
+		ok = ok && grava_secao(output, g->g_in.c_aresta, sizeof(UINT) * kin);
+	}
 
-	for( n=primeiro_no(l); n && !found; n=proximo_no(n) ) {
-		p = (aresta)conteudo(n);
-		found = ( p->a_orig == a->a_dst &&\
-				  p->a_dst  == a->a_orig );
+	ok = ok && fwrite(g->g_nome, 1, strlen(g->g_nome) + 1, output) == strlen(g->g_nome) + 1;
+	for( i = 0; ok && i < n; ++i ) {
+		tam = strlen(g->g_v[i]->v_nome) + 1;
+		ok = fwrite(g->g_v[i]->v_nome, 1, tam, output) == tam;
 	}
+	ok = ok && grava_secao(output, NULL, 0) && (c.b_tam_pool & 7 ? fwrite("\0\0\0\0\0\0\0", 1, 8 - (c.b_tam_pool & 7), output) == 8 - (c.b_tam_pool & 7) : TRUE);
 
-	return found;
+	free(u);
+	free(p);
+	FIM(e_ns_escrita, t0);
+
+	return ok ? g : NULL;
 }
 
 //------------------------------------------------------------------------------
-// Funcao para retornar quem é head, quem é tail em relação ao vertice vname.
-void check_head_tail(const char* vname, vertice* head, vertice* tail) {
-    vertice tmp;
+// Verifica que os índices da CSR c estão dentro dos limites.
+static bool csr_valida(const struct csr* c, UINT n, UINT m, UINT k) {
+	if( c->c_inicio[0] != 0 || c->c_inicio[n] != k ) return FALSE;
+	for( UINT i = 0; i < n; ++i )
+		if( c->c_inicio[i] > c->c_inicio[i+1] ) return FALSE;
+	for( UINT i = 0; i < k; ++i )
+		if( c->c_viz[i] >= n || c->c_aresta[i] >= m ) return FALSE;
+
+	return TRUE;
+}
 
-    if( strcmp(vname, (*head)->v_nome) != 0 ) {
-        if( strcmp(vname, (*tail)->v_nome) == 0 ) {
-            /* swap */
-            tmp = *head;
-            *head = *tail;
-            *tail = tmp;
-        }
-    }
+//------------------------------------------------------------------------------
+// Monta as listas de vizinhança de v a partir da CSR c (inversa à
+// construção da CSR: um laço não direcionado aparece duas vezes na lista).
+static void lista_da_csr(grafo g, const struct csr* c, UINT v, lista l) {
+	for( UINT k = c->c_inicio[v+1]; k-- > c->c_inicio[v]; ) {
+		aresta a = g->g_a[c->c_aresta[k]];
+		if( !g->g_tipo && a->a_orig == a->a_dst )
+			insere_lista(a, l);
+		if( !insere_lista(a, l) ) exit(EXIT_FAILURE);
+	}
 }
 
 //------------------------------------------------------------------------------
-void* mymalloc(size_t size) {
-	void* p;
+// lê um grafo gravado por grava_grafo_binario() de input
+//
+// devolve o grafo lido ou
+//         NULL em caso de erro
+grafo le_grafo_binario(FILE *input) {
+	struct cabecalho_bin	c;
+	struct entrada	e;
+	struct csr		out, in;
+	grafo		g;
+	vertice		v;
+	aresta		a;
+	char*		p;
+	char*		pool;
+	const UINT*	nomes;
+	const UINT*	orig;
+	const UINT*	dst;
+	const LINT*	peso;
+	char*		buf;
+	UINT		n, m, i, lacos;
+	bool		dir;
+	INICIO(t0);
+
+	if( !le_entrada_binario(input, &e) ) goto erro;
+	if( e.e_tam < sizeof(struct cabecalho_bin) ) goto erro;
+	memcpy(&c, e.e_buf, sizeof(struct cabecalho_bin));
+	n = c.b_nvertices;
+	m = c.b_narestas;
+	dir = (c.b_flags & BIN_DIRECIONADO) != 0;
+	if( memcmp(c.b_magica, bin_magica, sizeof(bin_magica)) != 0 ||
+		c.b_versao != BIN_VERSAO || c.b_tam > e.e_tam || c.b_tam_pool == 0 ||
+		c.b_tam_pool > e.e_tam - sizeof(struct cabecalho_bin) ||
+		(!dir && c.b_nviz_in) || n == UINT_MAX ||
+		c.b_tam != tam_binario(n, m, c.b_nviz_out, c.b_nviz_in, dir, c.b_tam_pool) )
+		goto erro;
+	if( e.e_mapa ) fseeko(input, e.e_pos + (off_t)c.b_tam, SEEK_SET);
+	// as seções precisam estar alinhadas em 8 bytes na memória.
+	if( (uintptr_t)e.e_buf & 7 ) {
+		buf = (char*)mymalloc(c.b_tam);
+		memcpy(buf, e.e_buf, c.b_tam);
+		libera_entrada(&e);
+		e.e_buf = buf;
+		e.e_tam = c.b_tam;
+	}
 
-	if( !(p = malloc(size)) ) {
-		perror("Could not allocate memory!");
-        exit(EXIT_FAILURE);
+	memset(&in, 0, sizeof(struct csr));
+	p = e.e_buf + sizeof(struct cabecalho_bin);
+	peso = (const LINT*)(void*)p;		p += BIN_ALINHA(sizeof(LINT) * m);
+	out.c_peso = (const LINT*)(void*)p;	p += sizeof(LINT) * c.b_nviz_out;
+	if( dir ) in.c_peso = (const LINT*)(void*)p;
+	p += BIN_ALINHA(sizeof(LINT) * c.b_nviz_in);
+	nomes = (const UINT*)(void*)p;		p += BIN_ALINHA(sizeof(UINT) * n);
+	orig = (const UINT*)(void*)p;		p += BIN_ALINHA(sizeof(UINT) * m);
+	dst = (const UINT*)(void*)p;		p += BIN_ALINHA(sizeof(UINT) * m);
+	out.c_inicio = (const UINT*)(void*)p;	p += BIN_ALINHA(sizeof(UINT) * (n + 1));
+	out.c_viz = (const UINT*)(void*)p;		p += BIN_ALINHA(sizeof(UINT) * c.b_nviz_out);
+	out.c_aresta = (const UINT*)(void*)p;	p += BIN_ALINHA(sizeof(UINT) * c.b_nviz_out);
+	if( dir ) {
+		in.c_inicio = (const UINT*)(void*)p;	p += BIN_ALINHA(sizeof(UINT) * (n + 1));
+		in.c_viz = (const UINT*)(void*)p;		p += BIN_ALINHA(sizeof(UINT) * c.b_nviz_in);
+		in.c_aresta = (const UINT*)(void*)p;	p += BIN_ALINHA(sizeof(UINT) * c.b_nviz_in);
+	}
+	pool = p;
+
+	if( pool[c.b_tam_pool - 1] != '\0' || !csr_valida(&out, n, m, c.b_nviz_out) ||
+		(dir && !csr_valida(&in, n, m, c.b_nviz_in)) ) goto erro;
+	for( i = 0; i < n; ++i )
+		if( nomes[i] >= c.b_tam_pool ) goto erro;
+	for( i = 0, lacos = 0; i < m; ++i ) {
+		if( orig[i] >= n || dst[i] >= n ) goto erro;
+		lacos += orig[i] == dst[i];
 	}
 
-	return p;
+	// ajuste dos apontadores: vértices, arestas e listas.
+	g = novo_grafo(NULL, dir);
+	g->g_ponderado = (c.b_flags & BIN_PONDERADO) != 0;
+	g->g_nvertices = n;
+	g->g_naresta = m;
+	g->g_nome = pool;
+	g->g_out = out;
+	g->g_in = in;
+	g->g_mapa = e;
+	g->g_csr_mapeada = TRUE;
+	g->g_v = (vertice*)mymalloc(sizeof(vertice) * (n ? n : 1));
+	g->g_a = (aresta*)mymalloc(sizeof(aresta) * (m ? m : 1));
+	// tudo que é montado aqui cabe num único bloco da arena (num grafo não
+	// direcionado, um laço ocupa dois nós da lista).
+	reserva_arena(&g->g_arena, (size_t)n * (sizeof(struct vertice) + 2 * sizeof(struct lista))
+		+ (size_t)m * sizeof(struct aresta)
+		+ ((size_t)out.c_inicio[n] + (dir ? in.c_inicio[n] : lacos)) * sizeof(struct no));
+	for( i = n; i-- > 0; ) {
+		v = (vertice)aloca_arena(&g->g_arena, sizeof(struct vertice));
+		memset(v, 0, sizeof(struct vertice));
+		v->v_nome = pool + nomes[i];
+		v->v_id = i;
+		v->v_neighborhood_in = constroi_lista_arena(&g->g_arena);
+		v->v_neighborhood_out = constroi_lista_arena(&g->g_arena);
+		if( !insere_lista(v, g->g_vertices) ) exit(EXIT_FAILURE);
+		g->g_v[i] = v;
+	}
+	for( i = 0; i < n; ++i )
+		insere_indice(g, g->g_v[i]);
+	for( i = 0; i < m; ++i ) {
+		a = (aresta)aloca_arena(&g->g_arena, sizeof(struct aresta));
+		memset(a, 0, sizeof(struct aresta));
+		a->a_peso = peso[i];
+		a->a_ponderado = g->g_ponderado;
+		a->a_id = i;
+		a->a_orig = g->g_v[orig[i]];
+		a->a_dst = g->g_v[dst[i]];
+		g->g_a[i] = a;
+	}
+	for( i = 0; i < n; ++i ) {
+		lista_da_csr(g, &g->g_out, i, g->g_v[i]->v_neighborhood_out);
+		if( dir )
+			lista_da_csr(g, &g->g_in, i, g->g_v[i]->v_neighborhood_in);
+	}
+	FIM(e_ns_leitura, t0);
+
+	return g;
+
+erro:
+	libera_entrada(&e);
+	FPF_ERR("Could not read graph!\n");
+	return NULL;
 }
 
-//------------------------------------------------------------------------------
-// Le todas as arestas the um grado não direcionado.
-static void BuildListOfEdges(grafo g, Agraph_t* Ag_g, Agnode_t* Ag_v, const char* head_name) {
-	UNUSED(head_name);
-	Agedge_t* 	Ag_e;
-	aresta 		a;
-	char*		weight;
-	char		str_weight[5] = "peso";
-	vertice		head, tail;
+/*
+ * Aqui termina o formato binario.
+ */
 
-	for( Ag_e=agfstedge(Ag_g, Ag_v); Ag_e; Ag_e=agnxtedge(Ag_g, Ag_e, Ag_v) ) {
-		if( agtail(Ag_e) == Ag_v ) {
-			a = (aresta)mymalloc(sizeof(struct aresta));
-			memset(a, 0, sizeof(struct aresta));
-			weight = agget(Ag_e, str_weight);
-			if( weight ) {
-				a->a_peso = atol(weight);
-				a->a_ponderado = TRUE;
-				g->g_ponderado = TRUE;
+/*________________________________________________________________*/
+/*
+ * Aqui comeca o processamento em lote.
+ *
+ * Cada grafo do lote é uma tarefa. As tarefas são repartidas em intervalos
+ * contíguos, um por thread; cada thread toma tarefas do início do seu
+ * intervalo e, quando ele acaba, rouba a metade final do intervalo de outra
+ * thread. A saída de cada grafo é escrita num buffer (open_memstream()) e a
+ * thread que chamou processa_lote() escreve os buffers em output na ordem da
+ * entrada, à medida que ficam prontos.
+ */
+
+// tarefas [f_ini, f_fim) de uma thread ainda não tomadas.
+struct fila_lote {
+	UINT			f_ini, f_fim;
+	pthread_mutex_t	f_trava;
+};
+
+struct resultado {
+	char*	r_buf;
+	size_t	r_tam;
+	bool	r_pronto;
+	bool	r_ok;			// o grafo foi lido.
+};
+
+struct lote {
+	const char*			l_texto;	// grafos concatenados, ou NULL.
+	size_t*				l_pecas;	// texto do grafo i: [l_pecas[i], l_pecas[i+1]).
+	char**				l_arquivos;	// arquivos dos grafos, ou NULL.
+	struct fila_lote*	l_filas;
+	struct resultado*	l_res;
+	UINT				l_n;		// número de grafos.
+	UINT				l_nthreads;
+	int					l_operacao;
+	int					padding;
+	pthread_mutex_t		l_trava;	// protege r_pronto.
+	pthread_cond_t		l_pronto;
+};
+
+struct trabalhador_lote {
+	struct lote*	t_l;
+	UINT			t_id;
+	UINT			padding;
+	pthread_t		t_thread;
+};
+
+//------------------------------------------------------------------------------
+// Procura em p[0..tam), a partir de s->vd_i, a chave que fecha o corpo do
+// primeiro grafo; strings, strings HTML e comentários são saltados.
+//
+// Se parcial, o texto pode continuar depois de tam: uma string ou comentário
+// que não termina em p[0..tam) é varrido de novo, do seu início, na próxima
+// chamada.
+//
+// devolve a posição seguinte à chave, ou 0 se ela não está em p[0..tam).
+static size_t varre_dot(const char* p, size_t tam, bool parcial, struct varredura_dot* s) {
+	size_t	i = s->vd_i, j;
+	UINT	html;
+
+	while( i < tam ) {
+		j = i;
+		if( p[i] == '"' ) {
+			for( ++i; i < tam && p[i] != '"'; ++i )
+				if( p[i] == '\\' ) ++i;
+			s->vd_conteudo = TRUE;
+			if( i >= tam && parcial ) { s->vd_i = j; return 0; }
+			++i;
+		} else if( p[i] == '<' && s->vd_prof ) {
+			for( html = 0; i < tam; ++i ) {
+				if( p[i] == '<' ) ++html;
+				else if( p[i] == '>' && --html == 0 ) break;
+			}
+			if( i >= tam && parcial ) { s->vd_i = j; return 0; }
+			++i;
+		} else if( (p[i] == '/' && i + 1 < tam && p[i+1] == '/') ||
+				(p[i] == '#' && (i == 0 || p[i-1] == '\n')) ) {
+			while( i < tam && p[i] != '\n' ) ++i;
+			if( i >= tam && parcial ) { s->vd_i = j; return 0; }
+		} else if( p[i] == '/' && i + 1 < tam && p[i+1] == '*' ) {
+			for( i += 2; i < tam && !(p[i] == '*' && i + 1 < tam && p[i+1] == '/'); ++i );
+			if( i >= tam && parcial ) { s->vd_i = j; return 0; }
+			i += 2;
+		} else {
+			if( p[i] == '{' )
+				++s->vd_prof;
+			else if( p[i] == '}' && s->vd_prof && --s->vd_prof == 0 ) {
+				s->vd_i = i + 1;
+				return i + 1;
 			}
-			tail = busca_vertice(agnameof(agtail(Ag_e)),\
-					agnameof(aghead(Ag_e)), g->g_vertices, &head);
-			a->a_orig = tail;
-			a->a_dst  = head;
-			if( !insere_lista(a, head->v_neighborhood_out ) ) exit(EXIT_FAILURE);
-			if( !insere_lista(a, tail->v_neighborhood_out ) ) exit(EXIT_FAILURE);
+			if( p[i] != ' ' && p[i] != '\t' && p[i] != '\n' && p[i] != '\r' )
+				s->vd_conteudo = TRUE;
+			++i;
 		}
 	}
+	s->vd_i = i;
+
+	return 0;
 }
 
 //------------------------------------------------------------------------------
-// Le todas os arcos de um grafo direcionato.
-static void BuildListOfArrows(grafo g, Agraph_t* Ag_g, Agnode_t* Ag_v, const char* head_name) {
-	Agedge_t* 	Ag_e;
-	aresta 		a;
-	char*		weight;
-	char		str_weight[5] = "peso";
-	vertice		head, tail;
+// devolve o tamanho do texto do primeiro grafo de p[0..tam), até a chave que
+// fecha seu corpo.
+//
+// devolve tam se o texto não tem um grafo completo, ou 0 se só tem brancos
+// e comentários.
+static size_t fim_grafo_dot(const char* p, size_t tam) {
+	struct varredura_dot	s = { 0, 0, FALSE };
+	size_t					k = varre_dot(p, tam, FALSE, &s);
 
-	for( Ag_e=agfstout(Ag_g, Ag_v); Ag_e; Ag_e=agnxtout(Ag_g, Ag_e) ) {
-		if( agtail(Ag_e) == Ag_v ) {
-			a = (aresta)mymalloc(sizeof(struct aresta));
-			memset(a, 0, sizeof(struct aresta));
-			weight = agget(Ag_e, str_weight);
-			if( weight ) {
-				a->a_peso = atol(weight);
-				a->a_ponderado = TRUE;
-				g->g_ponderado = TRUE;
-			}
-			tail = busca_vertice(agnameof(agtail(Ag_e)),\
-					agnameof(aghead(Ag_e)), g->g_vertices, &head);
-			check_head_tail(head_name, &head, &tail);
-			a->a_orig = head;
-			a->a_dst  = tail;
-			if( !insere_lista(a, tail->v_neighborhood_in ) ) exit(EXIT_FAILURE);
-			if( !insere_lista(a, head->v_neighborhood_out ) ) exit(EXIT_FAILURE);
+	return k ? k : s.vd_conteudo ? tam : 0;
+}
+
+//------------------------------------------------------------------------------
+// Lê o grafo i do lote, aplica a operação e guarda a saída em l_res[i].
+static void processa_grafo(struct lote* l, UINT i) {
+	struct resultado*	r = &l->l_res[i];
+	grafo	g = NULL, e;
+	FILE*	f;
+	size_t	usado;
+
+	if( l->l_arquivos ) {
+		if( (f = fopen(l->l_arquivos[i], "r")) != NULL ) {
+			g = le_grafo(f);
+			fclose(f);
+		} else
+			perror(l->l_arquivos[i]);
+	} else
+		g = le_grafo_memoria(l->l_texto + l->l_pecas[i], l->l_pecas[i+1] - l->l_pecas[i], FALSE, &usado);
+
+	if( !(f = open_memstream(&r->r_buf, &r->r_tam)) ) {
+		perror("Could not allocate memory!");
+		exit(EXIT_FAILURE);
+	}
+	if( g ) {
+		if( l->l_operacao ) {
+			fprintf(f, "%s %d\n", g->g_nome ? g->g_nome : "", cordal(g));
+		} else {
+			e = emparelhamento_maximo(g);
+			escreve_grafo(f, e);
+			destroi_grafo(e);
 		}
+		destroi_grafo(g);
 	}
+	fclose(f);
+	r->r_ok = g != NULL;
+
+	pthread_mutex_lock(&l->l_trava);
+	r->r_pronto = TRUE;
+	pthread_cond_broadcast(&l->l_pronto);
+	pthread_mutex_unlock(&l->l_trava);
 }
 
 //------------------------------------------------------------------------------
-// Encontra um vertice baseado em seu nome.
-// devolve 	ponteiro para o elemento da lista head,
-// 			e tail em vdst.
-vertice busca_vertice(const char* tail, const char* head,
-		lista vertices, vertice* vdst) {
+// Toma a próxima tarefa da thread id em *i, roubando de outra thread se
+// preciso.
+//
+// devolve 0 se não há mais tarefas.
+static bool proxima_tarefa(struct lote* l, UINT id, UINT* i) {
+	struct fila_lote*	f = &l->l_filas[id];
+	struct fila_lote*	v;
+	UINT	k, meio, fim;
+
+	pthread_mutex_lock(&f->f_trava);
+	if( f->f_ini < f->f_fim ) {
+		*i = f->f_ini++;
+		pthread_mutex_unlock(&f->f_trava);
+		return TRUE;
+	}
+	pthread_mutex_unlock(&f->f_trava);
+
+	for( k = 1; k < l->l_nthreads; ++k ) {
+		v = &l->l_filas[(id + k) % l->l_nthreads];
+		pthread_mutex_lock(&v->f_trava);
+		if( v->f_ini == v->f_fim ) {
+			pthread_mutex_unlock(&v->f_trava);
+			continue;
+		}
+		meio = v->f_ini + (v->f_fim - v->f_ini) / 2;
+		fim = v->f_fim;
+		v->f_fim = meio;
+		pthread_mutex_unlock(&v->f_trava);
+
+		pthread_mutex_lock(&f->f_trava);
+		f->f_ini = meio + 1;
+		f->f_fim = fim;
+		pthread_mutex_unlock(&f->f_trava);
+		*i = meio;
+		return TRUE;
+	}
 
-    int many = 0;
-    vertice r_tail = NULL;
-    vertice tmp = NULL;
-    *vdst = NULL;
+	return FALSE;
+}
 
-    for( no n=primeiro_no(vertices); n && many < 2; n=proximo_no(n) ) {
-    	tmp = (vertice)conteudo(n);
-        if( strcmp(tail, tmp->v_nome) == 0 ) {
-        	r_tail = tmp;
-        	many++;
-        }
-        if( strcmp(head, tmp->v_nome) == 0 ) {
-        	*vdst = tmp;
-        	many++;
-        }
-    }
+//------------------------------------------------------------------------------
+static void* trabalha_lote(void* arg) {
+	struct trabalhador_lote*	t = (struct trabalhador_lote*)arg;
+	UINT	i;
 
-    return r_tail;
+	while( proxima_tarefa(t->t_l, t->t_id, &i) )
+		processa_grafo(t->t_l, i);
+
+	return NULL;
 }
 
 //------------------------------------------------------------------------------
-// retorna o próximo vizinho a direita da lista l.
-vertice nxt_neighbor_r(lista l) {
-	vertice smallest_vi;
-	no nv = primeiro_no(l);
+int processa_lote(FILE *input, char **arquivos, unsigned int n_arquivos,
+		int operacao, unsigned int n_threads, FILE *output) {
+	struct lote					l;
+	struct entrada				e;
+	struct trabalhador_lote*	t;
+	size_t	pos, k, cap;
+	UINT	i;
+	int		falhas = 0;
+
+	memset(&l, 0, sizeof(struct lote));
+	memset(&e, 0, sizeof(struct entrada));
+	l.l_operacao = operacao;
+	l.l_nthreads = n_threads ? n_threads : 1;
+	if( arquivos ) {
+		l.l_arquivos = arquivos;
+		l.l_n = n_arquivos;
+	} else {
+		if( !le_entrada(input, &e) ) {
+			FPF_ERR("Could not read graph!\n");
+			return -1;
+		}
+		// separa os grafos concatenados.
+		l.l_texto = e.e_buf;
+		cap = 64;
+		l.l_pecas = (size_t*)mymalloc(sizeof(size_t) * cap);
+		l.l_pecas[0] = 0;
+		for( pos = 0; pos < e.e_tam && (k = fim_grafo_dot(e.e_buf + pos, e.e_tam - pos)); pos += k ) {
+			if( l.l_n + 2 > cap ) {
+				cap *= 2;
+				l.l_pecas = (size_t*)myrealloc(l.l_pecas, sizeof(size_t) * cap);
+			}
+			l.l_pecas[++l.l_n] = pos + k;
+		}
+	}
 
-	if( !nv ) return NULL;
-	smallest_vi = conteudo(nv);
-	for (nv = proximo_no(nv); nv; nv = proximo_no(nv)) {
-		vertice v = conteudo(nv);
-		if (v->v_index < smallest_vi->v_index)
-			smallest_vi = v;
+	l.l_res = (struct resultado*)mymalloc(sizeof(struct resultado) * (l.l_n ? l.l_n : 1));
+	memset(l.l_res, 0, sizeof(struct resultado) * l.l_n);
+	l.l_filas = (struct fila_lote*)mymalloc(sizeof(struct fila_lote) * l.l_nthreads);
+	t = (struct trabalhador_lote*)mymalloc(sizeof(struct trabalhador_lote) * l.l_nthreads);
+	pthread_mutex_init(&l.l_trava, NULL);
+	pthread_cond_init(&l.l_pronto, NULL);
+	for( i = 0; i < l.l_nthreads; ++i ) {
+		l.l_filas[i].f_ini = (UINT)((uint64_t)l.l_n * i / l.l_nthreads);
+		l.l_filas[i].f_fim = (UINT)((uint64_t)l.l_n * (i + 1) / l.l_nthreads);
+		pthread_mutex_init(&l.l_filas[i].f_trava, NULL);
+	}
+	for( i = 0; i < l.l_nthreads; ++i ) {
+		t[i].t_l = &l;
+		t[i].t_id = i;
+		if( pthread_create(&t[i].t_thread, NULL, trabalha_lote, &t[i]) ) {
+			perror("Could not create thread!");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	// escreve as saídas na ordem da entrada.
+	for( i = 0; i < l.l_n; ++i ) {
+		pthread_mutex_lock(&l.l_trava);
+		while( !l.l_res[i].r_pronto )
+			pthread_cond_wait(&l.l_pronto, &l.l_trava);
+		pthread_mutex_unlock(&l.l_trava);
+		fwrite(l.l_res[i].r_buf, 1, l.l_res[i].r_tam, output);
+		free(l.l_res[i].r_buf);
+		if( !l.l_res[i].r_ok ) ++falhas;
 	}
 
-	return smallest_vi;
+	for( i = 0; i < l.l_nthreads; ++i )
+		pthread_join(t[i].t_thread, NULL);
+	for( i = 0; i < l.l_nthreads; ++i )
+		pthread_mutex_destroy(&l.l_filas[i].f_trava);
+	pthread_mutex_destroy(&l.l_trava);
+	pthread_cond_destroy(&l.l_pronto);
+	free(t);
+	free(l.l_filas);
+	free(l.l_res);
+	free(l.l_pecas);
+	if( !arquivos ) libera_entrada(&e);
+
+	return falhas;
 }
 
 /*
- *##################################################################
- * Block that represents module for heap operations. Esta imple -
- * mentação usa o min heap, ou seja, o menor valor será a raiz.
- *
- * Ref.: https://pt.wikipedia.org/wiki/Heap
- *##################################################################
+ * Aqui termina o processamento em lote.
  */
-#define DAD(k) 		( ((k) - 1) >> 1 )
-#define L_CHILD(k)	( (((k) + 1) << 1) - 1 )
-#define R_CHILD(k)	( ((k) + 1) << 1 );
 
-PHEAP heap_alloc(int elem) {
-	PHEAP heap = (PHEAP)malloc(sizeof(HEAP));
-	if( !heap ) exit(EXIT_FAILURE);
-	heap->v = (vertice*)malloc(sizeof(struct vertice) * (size_t)elem);
-	if( !heap->v ) exit(EXIT_FAILURE);
-	heap->elem = elem;
-	heap->pos = 0;
+//------------------------------------------------------------------------------
+// Hash FNV-1a do nome de um vértice.
+UINT hash_nome(const char* s) {
+	UINT h = 2166136261u;
 
-	return heap;
+	while( *s ) {
+		h ^= (unsigned char)*s++;
+		h *= 16777619u;
+	}
 
+	return h;
 }
 
 //------------------------------------------------------------------------------
-void heap_free(PHEAP heap) {
-	free(heap->v);
-	free(heap);
+// Insere v no índice de nomes de g, dobrando a tabela quando ela passa de
+// metade cheia. Não verifica se já existe vértice com o mesmo nome.
+void insere_indice(grafo g, vertice v) {
+	struct indice*	ix = &g->g_indice;
+	vertice*		vert;
+	UINT*			hash;
+	UINT			cap, i, h;
+
+	if( !ix->i_vert || 2 * (ix->i_n + 1) > ix->i_mascara + 1 ) {
+		cap = ix->i_vert ? 2 * (ix->i_mascara + 1) : 16;
+		vert = (vertice*)mymalloc(sizeof(vertice) * cap);
+		hash = (UINT*)mymalloc(sizeof(UINT) * cap);
+		memset(vert, 0, sizeof(vertice) * cap);
+		for( UINT k = 0; ix->i_vert && k <= ix->i_mascara; ++k ) {
+			if( !ix->i_vert[k] ) continue;
+			for( i = ix->i_hash[k] & (cap - 1); vert[i]; i = (i + 1) & (cap - 1) );
+			vert[i] = ix->i_vert[k];
+			hash[i] = ix->i_hash[k];
+		}
+		free(ix->i_vert);
+		free(ix->i_hash);
+		ix->i_vert = vert;
+		ix->i_hash = hash;
+		ix->i_mascara = cap - 1;
+	}
+
+	h = hash_nome(v->v_nome);
+	for( i = h & ix->i_mascara; ix->i_vert[i]; i = (i + 1) & ix->i_mascara );
+	ix->i_vert[i] = v;
+	ix->i_hash[i] = h;
+	ix->i_n++;
 }
 
 //------------------------------------------------------------------------------
-// menor rótulo
-int lbl_g(int *x, int *y) {
-	int i = 0;
+// Desaloca o índice de nomes de g.
+void destroi_indice(grafo g) {
+	free(g->g_indice.i_vert);
+	free(g->g_indice.i_hash);
+	memset(&g->g_indice, 0, sizeof(struct indice));
+}
 
-	while( *(x+i) == *(y+i) ) {
-		if( *(x+i) == 0 )
-			return 0;
-		i++;
+//------------------------------------------------------------------------------
+// devolve o vértice de nome nome em g, ou
+//         NULL, se g não tem vértice com esse nome
+vertice busca_vertice_nome(const char *nome, grafo g) {
+	const struct indice* ix = &g->g_indice;
+	UINT	i, h;
+
+	CONTA(e_buscas_nome, 1);
+	if( !ix->i_vert ) return NULL;
+
+	h = hash_nome(nome);
+	for( i = h & ix->i_mascara; ix->i_vert[i]; i = (i + 1) & ix->i_mascara ) {
+		if( ix->i_hash[i] != h ) continue;
+		CONTA(e_comparacoes_nome, 1);
+		if( strcmp(nome, ix->i_vert[i]->v_nome) == 0 )
+			return ix->i_vert[i];
 	}
 
-	return( *(x+i) > *(y+i) );
+	return NULL;
 }
 
 //------------------------------------------------------------------------------
-// rótulo maior ou igual.
-int lbl_ge(int *x, int *y) {
-	int i = 0;
+// Hash do par (u,w) do índice de adjacência.
+static UINT hash_par(uint64_t chave) {
+	return (UINT)((chave * 0x9e3779b97f4a7c15ull) >> 32);
+}
 
-	while( *(x+i) == *(y+i) ) {
-		if( *(x+i) == 0 )
-			return 1;
-		i++;
+//------------------------------------------------------------------------------
+// Preenche o índice de adjacência de g a partir de g_out, com capacidade de
+// pelo menos o dobro do número de pares.
+void constroi_adjacencia(grafo g) {
+	struct adjacencia*	ad = &g->g_adj;
+	UINT		k, u, i, cap = 16, m = g->g_out.c_inicio[g->g_nvertices];
+	uint64_t	chave;
+
+	while( cap < 2 * m ) cap *= 2;
+	ad->a_chaves = (uint64_t*)mymalloc(sizeof(uint64_t) * cap);
+	memset(ad->a_chaves, 0xff, sizeof(uint64_t) * cap);
+	ad->a_mascara = cap - 1;
+	for( u = 0; u < g->g_nvertices; ++u ) {
+		for( k = g->g_out.c_inicio[u]; k < g->g_out.c_inicio[u+1]; ++k ) {
+			chave = (uint64_t)u << 32 | g->g_out.c_viz[k];
+			for( i = hash_par(chave) & ad->a_mascara; ad->a_chaves[i] != ADJ_LIVRE
+				&& ad->a_chaves[i] != chave; i = (i + 1) & ad->a_mascara );
+			ad->a_chaves[i] = chave;
+		}
 	}
-
-	return *(x+i) >= *(y+i);
 }
 
 //------------------------------------------------------------------------------
-void heap_push(PHEAP heap, vertice data) {
-	int u, z;
-	vertice tmp;
-
-	if( heap->pos == heap->elem ) return;
+// Desaloca a tabela do índice de adjacência de g (que continua ativo, se
+// estava).
+void destroi_adjacencia(grafo g) {
+	free(g->g_adj.a_chaves);
+	g->g_adj.a_chaves = NULL;
+	g->g_adj.a_mascara = 0;
+	g->g_csr_pronta = FALSE;
+}
 
-	z = heap->pos;
-	*(heap->v+z) = data;
-	heap->pos++;
+//------------------------------------------------------------------------------
+// devolve 1 se o par (u,w) está no índice ad, ou 0 caso contrário.
+static int adjacentes_indice(const struct adjacencia* ad, UINT u, UINT w) {
+	uint64_t	chave = (uint64_t)u << 32 | w;
+	UINT		i;
 
-	while( z ) {
-		u = DAD(z);
-		if( lbl_ge((*(heap->v+u))->v_lbl , (*(heap->v+z))->v_lbl) ) break;
+	for( i = hash_par(chave) & ad->a_mascara; ad->a_chaves[i] != ADJ_LIVRE; i = (i + 1) & ad->a_mascara )
+		if( ad->a_chaves[i] == chave )
+			return 1;
 
-		tmp = *(heap->v + u);
-		*(heap->v+u) = *(heap->v + z);
-		*(heap->v+z) = tmp;
-		z = u;
-	}
+	return 0;
 }
 
 //------------------------------------------------------------------------------
-vertice heap_pop(PHEAP heap) {
-	int k, l, r, child;
-	vertice tmp, ret;
+void indexa_adjacencia(grafo g) {
+	g->g_adj.a_ativo = TRUE;
+	g->g_csr_pronta = FALSE;
+	garante_csr(g);
+}
 
-	if( heap->pos == 0 ) return NULL;
 
-	ret = *heap->v;
-	heap->pos--;
-	*heap->v = *(heap->v + heap->pos);
+/*________________________________________________________________*/
+/*
+ * Aqui comeca estatisticas.
+ */
 
-	k = 0;
-	while( (l = L_CHILD(r)) < heap->pos ) {
-		r = R_CHILD(k);
-		if( r < heap->pos && lbl_g((*(heap->v+l))->v_lbl, (*(heap->v+r))->v_lbl) )
-			child = r;
-		else child = l;
+#ifdef GRAFO_ESTATISTICAS
+//------------------------------------------------------------------------------
+static unsigned long relogio_ns(void) {
+	struct timespec t;
 
-		if( lbl_g((*(heap->v+k))->v_lbl, (*(heap->v+child))->v_lbl) ) {
-			tmp = *(heap->v + child);
-			*(heap->v+child) = *(heap->v + k);
-			*(heap->v+k) = tmp;
-			k = child;
-		} else break;
-	}
+	clock_gettime(CLOCK_MONOTONIC, &t);
 
-	return ret;
+	return (unsigned long)t.tv_sec * 1000000000ul + (unsigned long)t.tv_nsec;
 }
+#endif
 
 //------------------------------------------------------------------------------
-void heap_sort(PHEAP heap, int i) {
-    int l, r, maior;
-    l = L_CHILD(i);
-    r = R_CHILD(i);
-    if ((l < heap->pos) && lbl_g(heap->v[l]->v_lbl, heap->v[i]->v_lbl)) {
-        maior = l;
-    } else {
-        maior = i;
-    }
-    if ((r < heap->pos) && lbl_g(heap->v[r]->v_lbl, heap->v[i]->v_lbl)) {
-        maior = r;
-    }
-    if (maior != i) {
-        vertice tmp = heap->v[maior];
-        heap->v[maior] = heap->v[i];
-        heap->v[i] = tmp;
-        heap_sort(heap, maior);
-    }
+void obtem_estatisticas(struct estatisticas* e) {
+	memset(e, 0, sizeof(struct estatisticas));
+#ifdef GRAFO_ESTATISTICAS
+	// cada contador é lido atomicamente (mas não o conjunto).
+	for( size_t i = 0; i < sizeof(struct estatisticas) / sizeof(unsigned long); ++i )
+		((unsigned long*)e)[i] = __atomic_load_n((unsigned long*)&estat + i, __ATOMIC_RELAXED);
+#endif
+}
+
+//------------------------------------------------------------------------------
+void zera_estatisticas(void) {
+#ifdef GRAFO_ESTATISTICAS
+	for( size_t i = 0; i < sizeof(struct estatisticas) / sizeof(unsigned long); ++i )
+		__atomic_store_n((unsigned long*)&estat + i, 0, __ATOMIC_RELAXED);
+#endif
 }
 
 //------------------------------------------------------------------------------
-// Corrige descendo, tambem chamado de heapify.
-void heapify(PHEAP heap) {
-	for( int i = heap->pos >> 1; i >= 0; --i )
-		heap_sort(heap, i);
+int escreve_estatisticas(FILE *output) {
+	struct estatisticas e;
+	int r;
+
+	obtem_estatisticas(&e);
+	r = fprintf(output,
+		"{\"ativo\": %s,\n"
+		" \"emparelhamento\": {\"fases\": %lu, \"caminhos\": %lu, \"emparelhados_ks\": %lu, "
+		"\"vertices_visitados\": %lu, \"arestas_examinadas\": %lu},\n"
+		" \"busca\": {\"lex_classes\": %lu, \"lex_movidos\": %lu, \"mcs_movidos\": %lu, "
+		"\"eliminacao_testes\": %lu},\n"
+		" \"leitura\": {\"buscas_nome\": %lu, \"comparacoes_nome\": %lu, \"alocacoes\": %lu, "
+		"\"bytes_alocados\": %lu, \"blocos_arena\": %lu},\n"
+		" \"tempo_ns\": {\"leitura\": %lu, \"emparelhamento\": %lu, \"busca\": %lu, "
+		"\"eliminacao\": %lu, \"escrita\": %lu}}\n",
+#ifdef GRAFO_ESTATISTICAS
+		"true",
+#else
+		"false",
+#endif
+		e.e_fases, e.e_caminhos, e.e_emparelhados_ks, e.e_vertices_visitados, e.e_arestas_examinadas,
+		e.e_lex_classes, e.e_lex_movidos, e.e_mcs_movidos, e.e_eliminacao_testes,
+		e.e_buscas_nome, e.e_comparacoes_nome, e.e_alocacoes, e.e_bytes_alocados, e.e_blocos_arena,
+		e.e_ns_leitura, e.e_ns_emparelhamento, e.e_ns_busca, e.e_ns_eliminacao, e.e_ns_escrita);
+
+	return r > 0;
 }
+
+/*
+ * Aqui termina estatisticas.
+ */
@@ -125,7 +125,20 @@ typedef struct vertice *vertice;
 char *nome_vertice(vertice v);
 
 //------------------------------------------------------------------------------
-// lê um grafo no formato dot de input, usando as rotinas de libcgraph
+// devolve o vértice de nome nome no grafo g, ou
+//         NULL, se g não tem vértice com esse nome
+//
+// o tempo esperado de execução é O(1) (além do tamanho do nome)
+
+vertice busca_vertice_nome(const char *nome, grafo g);
+
+//------------------------------------------------------------------------------
+// lê um grafo no formato dot de input
+//
+// grafos no subconjunto de dot formado por vértices, arestas/arcos e
+// atributos são lidos numa única passada por um leitor próprio, direto do
+// arquivo mapeado em memória (ou de um buffer, se input não é um arquivo
+// regular); as demais construções são lidas usando as rotinas de libcgraph
 // 
 // desconsidera todos os atributos do grafo lido exceto o atributo
 // "peso" quando ocorrer; neste caso o valor do atributo é o peso da
@@ -167,11 +180,128 @@ int destroi_grafo(void *g);
 
 grafo escreve_grafo(FILE *output, grafo g);
 
+//------------------------------------------------------------------------------
+// escreve o grafo g em output num formato binário versionado (snapshot)
+// que le_grafo_binario() carrega sem interpretar texto
+//
+// o formato depende da ordem de bytes e do tamanho de long int da máquina
+//
+// devolve o grafo escrito ou
+//         NULL em caso de erro
+
+grafo grava_grafo_binario(FILE *output, grafo g);
+
+//------------------------------------------------------------------------------
+// lê de input um grafo escrito por grava_grafo_binario()
+//
+// se input é um arquivo regular, ele é mapeado em memória e a vizinhança,
+// os pesos e os nomes são usados diretamente do mapeamento, que é desfeito
+// por destroi_grafo()
+//
+// devolve o grafo lido ou
+//         NULL em caso de erro
+
+grafo le_grafo_binario(FILE *input);
+
+//------------------------------------------------------------------------------
+// processa um lote de grafos em n_threads threads
+//
+// os grafos são lidos dos n_arquivos arquivos em arquivos ou, se
+// arquivos == NULL, de input, que contém um ou mais grafos no formato dot
+// concatenados
+//
+// se operacao == 0, escreve em output o emparelhamento máximo de cada grafo
+//                   (ver emparelhamento_maximo() e escreve_grafo())
+//
+// se operacao == 1, escreve em output uma linha com o nome de cada grafo
+//                   seguido de 1, se ele é cordal, ou 0, caso contrário
+//
+// as saídas são escritas na ordem em que os grafos aparecem na entrada
+//
+// devolve o número de grafos que não puderam ser lidos, ou
+//         -1 se input não pôde ser lido
+
+int processa_lote(FILE *input, char **arquivos, unsigned int n_arquivos,
+                  int operacao, unsigned int n_threads, FILE *output);
+
 //------------------------------------------------------------------------------
 // devolve um grafo igual a g
+//
+// a cópia é independente de g (pode ser alterada ou sobreviver a ele) e
+// custa O(V+E), sem buscas por nome
 
 grafo copia_grafo(grafo g);
 
+//------------------------------------------------------------------------------
+// memória ocupada por um grafo, em bytes, por categoria (ver memoria_grafo())
+
+struct memoria {
+
+  size_t m_grafo;           // a estrutura do grafo
+  size_t m_vertices;        // estruturas dos vértices e o vetor de vértices
+  size_t m_nomes;           // nomes do grafo e dos vértices
+  size_t m_arestas;         // estruturas das arestas e o vetor de arestas
+  size_t m_listas;          // listas de vizinhança e de vértices (com os nós)
+  size_t m_csr;             // vizinhanças compactadas
+  size_t m_indice;          // índice dos vértices pelo nome
+  size_t m_adjacencia;      // índice de adjacência (indexa_adjacencia())
+  size_t m_arena;           // blocos de onde vêm vértices, nomes, arestas e listas
+  size_t m_arena_livre;     // parte desses blocos ainda não usada
+  size_t m_reuso;           // nós e arestas removidos, guardados para reúso
+  size_t m_mapa;            // snapshot binário (le_grafo_binario())
+  size_t m_total;           // tudo o que pertence ao grafo
+
+  // maior área de trabalho (temporária) usada por um algoritmo executado
+  // sobre o grafo desde que ele foi criado
+  size_t m_pico_auxiliar;
+};
+
+//------------------------------------------------------------------------------
+// devolve o número de bytes ocupados pelo grafo g e, se m != NULL,
+// preenche *m com a divisão por categoria
+//
+// m_total é a soma de m_grafo, m_arena, m_csr, m_indice, m_adjacencia,
+// m_mapa e dos vetores de vértices e de arestas; vértices, nomes, arestas e
+// listas ficam dentro de m_arena (ou, num grafo lido por
+// le_grafo_binario(), os nomes ficam em m_mapa), assim como m_reuso
+//
+// a função não altera g: se uma alteração de g descartou a CSR (que é
+// refeita no próximo uso), m_csr e os vetores de vértices e de arestas
+// não são contados
+//
+// o tempo de execução é O(|V(G)|)
+
+size_t memoria_grafo(grafo g, struct memoria *m);
+
+//------------------------------------------------------------------------------
+// critérios de reordena_grafo()
+
+enum {
+
+  ORDEM_LARGURA,         // busca em largura, componente a componente
+  ORDEM_CUTHILL_MCKEE,   // Cuthill-McKee reverso
+  ORDEM_GRAU             // grau decrescente
+};
+
+//------------------------------------------------------------------------------
+// renumera os vértices de g segundo criterio e reorganiza as vizinhanças
+// (e as arestas) de acordo, para que vértices próximos na ordem fiquem
+// próximos na memória
+//
+// os vértices (e seus nomes) continuam os mesmos; mudam a ordem dos
+// vértices, a ordem de cada vizinhança (que fica crescente na nova ordem)
+// e, portanto, a ordem em que os algoritmos e escreve_grafo() percorrem o
+// grafo
+//
+// convém chamá-la logo depois de ler o grafo, antes dos algoritmos
+//
+// devolve 1 em caso de sucesso, ou
+//         0 se criterio é inválido
+//
+// o tempo de execução é O(|V(G)|+|E(G)| log |V(G)|)
+
+int reordena_grafo(grafo g, int criterio);
+
 //------------------------------------------------------------------------------
 // devolve a vizinhança do vértice v no grafo g
 // 
@@ -183,14 +313,67 @@ grafo copia_grafo(grafo g);
 //
 // se direcao == 1, v é um vértice de um grafo direcionado e a função
 //                  devolve sua vizinhanca de saída
+//
+// o conteúdo de cada nó da lista é uma aresta (interna) de v; para
+// percorrer os vizinhos use vizinhos_de()
 
 lista vizinhanca(vertice v, int direcao, grafo g);
 
+//------------------------------------------------------------------------------
+// vizinhos de um vértice, em memória contígua: o i-ésimo vizinho é
+// vizinho(&s, i) e o peso da aresta até ele é peso_vizinho(&s, i), para
+// 0 <= i < s.vz_n
+//
+// um vizinho aparece uma vez para cada aresta até ele, na ordem de
+// vizinhanca(); um laço aparece uma vez, enquanto grau() (e vizinhanca(), num
+// grafo não direcionado) o conta duas vezes: vz_lacos é o número de laços de
+// v nesse caso (0 num grafo direcionado), de forma que
+// grau(v, direcao, g) == s.vz_n + s.vz_lacos
+//
+// os campos são só para as funções abaixo; os vetores são internos ao grafo
+// e deixam de valer quando ele é alterado (insere_aresta(), remove_aresta())
+// ou destruído
+
+struct vizinhos {
+
+  const unsigned int *vz_indice;   // índice de cada vizinho
+  const long int *vz_peso;         // peso da aresta até cada vizinho
+  vertice const *vz_vertices;      // vértices do grafo, por índice
+  unsigned int vz_n;               // número de vizinhos
+  unsigned int vz_lacos;           // laços de v contados duas vezes por grau()
+};
+
+//------------------------------------------------------------------------------
+// devolve os vizinhos do vértice v no grafo g (ver vizinhanca() para
+// direcao)
+//
+// não aloca memória; o tempo de execução é O(1) (se g não foi alterado
+// desde a última consulta)
+
+struct vizinhos vizinhos_de(vertice v, int direcao, grafo g);
+
+//------------------------------------------------------------------------------
+// devolve o i-ésimo vizinho em s
+
+static inline vertice vizinho(const struct vizinhos *s, unsigned int i) {
+
+  return s->vz_vertices[s->vz_indice[i]];
+}
+
+//------------------------------------------------------------------------------
+// devolve o peso da aresta até o i-ésimo vizinho em s
+
+static inline long int peso_vizinho(const struct vizinhos *s, unsigned int i) {
+
+  return s->vz_peso[i];
+}
+
 //------------------------------------------------------------------------------
 // devolve o grau do vértice v no grafo g
 // 
 // se direcao == 0, v é um vértice de um grafo não direcionado
-//                  e a função devolve seu grau
+//                  e a função devolve seu grau, em que cada laço conta duas
+//                  vezes (ver vizinhos_de())
 //
 // se direcao == -1, v é um vértice de um grafo direcionado
 //                   e a função devolve seu grau de entrada
@@ -217,12 +400,55 @@ int clique(lista l, grafo g);
 
 int simplicial(vertice v, grafo g);
 
+//------------------------------------------------------------------------------
+// devolve uma lista com os vértices simpliciais do grafo não direcionado g,
+// na ordem de g
+//
+// o tempo de execução é O(|V(G)|+|E(G)|) mais O(grau(v)² log grau(u)) por
+// vértice v, onde u é o vizinho de maior grau de v; é quase linear em
+// grafos esparsos
+
+lista vertices_simpliciais(grafo g);
+
+//------------------------------------------------------------------------------
+// como vertices_simpliciais(), dividindo os vértices entre n_threads threads
+// (a que chama inclusive)
+
+lista vertices_simpliciais_paralelo(grafo g, unsigned int n_threads);
+
+//------------------------------------------------------------------------------
+// constrói um índice de adjacência de g, usado por clique() e simplicial()
+// (e mantido depois de alterações em g) até a desalocação de g
+//
+// com o índice, cada teste de vizinhança é O(1) esperado; clique(l, g)
+// passa a custar O(|l|²) e simplicial(v, g), O(grau(v)²)
+//
+// o índice ocupa O(|E(G)|) de memória
+
+void indexa_adjacencia(grafo g);
+
 //------------------------------------------------------------------------------
 // devolve uma lista de vertices com a ordem dos vértices dada por uma 
 // busca em largura lexicográfica
+//
+// a lista está na ordem inversa da visita e contém todos os vértices de g,
+// mesmo que g não seja conexo
+//
+// o tempo de execução é O(|V(G)|+|E(G)|) e a memória extra é O(|V(G)|)
 
 lista busca_largura_lexicografica(grafo g);
 
+//------------------------------------------------------------------------------
+// devolve uma lista de vertices com a ordem dos vértices dada por uma
+// busca de cardinalidade máxima (MCS), na ordem inversa da visita
+//
+// como a da busca em largura lexicográfica, a ordem é de eliminação perfeita
+// se e somente se g é cordal
+//
+// o tempo de execução é O(|V(G)|+|E(G)|)
+
+lista busca_cardinalidade_maxima(grafo g);
+
 //------------------------------------------------------------------------------
 // devolve 1, se a lista l representa uma 
 //            ordem perfeita de eliminação para o grafo g ou
@@ -238,6 +464,73 @@ int ordem_perfeita_eliminacao(lista l, grafo g);
 
 int cordal(grafo g);
 
+//------------------------------------------------------------------------------
+// como cordal(), usando busca_cardinalidade_maxima() em vez de
+// busca_largura_lexicografica()
+
+int cordal_mcs(grafo g);
+
+//------------------------------------------------------------------------------
+// devolve uma lista com as cliques maximais do grafo cordal não direcionado
+// g, cada uma delas uma lista de vértices (como as aceitas por clique()), ou
+// NULL, se g não é cordal
+//
+// as cliques são obtidas da ordem perfeita de eliminação de
+// busca_largura_lexicografica(); um grafo cordal tem no máximo |V(G)|
+// cliques maximais e o tempo de execução é O(|V(G)|+|E(G)|)
+//
+// a lista devolvida é desalocada com destroi_lista(l, destroi_clique)
+
+lista cliques_maximais(grafo g);
+
+//------------------------------------------------------------------------------
+// devolve uma lista com os vértices de uma clique de tamanho máximo do grafo
+// cordal não direcionado g, ou NULL, se g não é cordal
+//
+// o tempo de execução é O(|V(G)|+|E(G)|)
+
+lista clique_maxima(grafo g);
+
+//------------------------------------------------------------------------------
+// desaloca uma clique (lista de vértices) devolvida por cliques_maximais()
+//
+// devolve 1 em caso de sucesso ou 0 em caso de falha
+
+int destroi_clique(void *c);
+
+//------------------------------------------------------------------------------
+// (apontador para) contexto de consulta: a área de trabalho de
+// busca_largura_lexicografica(), busca_cardinalidade_maxima(),
+// ordem_perfeita_eliminacao() e cordal()
+//
+// essas funções não alteram o grafo; as versões _r usam o contexto dado em
+// vez de alocar um a cada chamada, e podem ser chamadas ao mesmo tempo, em
+// threads distintas, sobre o mesmo grafo, desde que cada thread use seu
+// próprio contexto e que o grafo não seja alterado enquanto isso
+
+typedef struct consulta *consulta;
+
+//------------------------------------------------------------------------------
+// devolve um contexto de consulta dimensionado para g
+
+consulta constroi_consulta(grafo g);
+
+//------------------------------------------------------------------------------
+// desaloca o contexto de consulta q
+
+void destroi_consulta(consulta q);
+
+//------------------------------------------------------------------------------
+// versões de busca_largura_lexicografica(), busca_cardinalidade_maxima(),
+// ordem_perfeita_eliminacao(), cordal() e cordal_mcs() que usam o contexto
+// de consulta q
+
+lista busca_largura_lexicografica_r(grafo g, consulta q);
+lista busca_cardinalidade_maxima_r(grafo g, consulta q);
+int ordem_perfeita_eliminacao_r(lista l, grafo g, consulta q);
+int cordal_r(grafo g, consulta q);
+int cordal_mcs_r(grafo g, consulta q);
+
 //------------------------------------------------------------------------------
 // devolve um grafo cujos vertices são cópias de vértices do grafo
 // bipartido g e cujas arestas formam um emparelhamento máximo em g
@@ -245,7 +538,110 @@ int cordal(grafo g);
 // o grafo devolvido, portanto, é vazio ou tem todos os vértices com grau 1
 //
 // não verifica se g é bipartido; caso não seja, o comportamento é indefinido
+//
+// o tempo de execução é O(sqrt(|V(G)|)·|E(G)|) (Hopcroft-Karp)
 
 grafo emparelhamento_maximo(grafo g);
 
+//------------------------------------------------------------------------------
+// como emparelhamento_maximo(), dividindo cada fase de Hopcroft-Karp entre
+// n_threads threads (a que chama inclusive)
+//
+// se deterministico é diferente de 0, o emparelhamento devolvido é sempre o
+// mesmo para o mesmo g, qualquer que seja n_threads; caso contrário pode
+// variar de uma execução para outra (mas é sempre máximo)
+
+grafo emparelhamento_maximo_paralelo(grafo g, unsigned int n_threads, int deterministico);
+
+//------------------------------------------------------------------------------
+// acrescenta a aresta {u,v} (de peso 0) ao grafo não direcionado g e
+// atualiza o emparelhamento de g com uma única busca por caminho aumentante
+//
+// o emparelhamento de g é o calculado pela última chamada de
+// emparelhamento_maximo() (ou vazio), mantido por insere_aresta() e
+// remove_aresta(); se ele é máximo, continua máximo
+//
+// devolve 1 em caso de sucesso, ou
+//         0, se g é direcionado ou já tem a aresta {u,v}
+
+int insere_aresta(grafo g, vertice u, vertice v);
+
+//------------------------------------------------------------------------------
+// remove a aresta {u,v} do grafo não direcionado g e atualiza o
+// emparelhamento de g (ver insere_aresta())
+//
+// devolve 1 em caso de sucesso, ou
+//         0, se g é direcionado ou não tem a aresta {u,v}
+
+int remove_aresta(grafo g, vertice u, vertice v);
+
+//------------------------------------------------------------------------------
+// devolve um grafo cujos vertices são cópias de vértices de g e cujas
+// arestas formam o emparelhamento de g mantido por insere_aresta() e
+// remove_aresta(), sem recalculá-lo
+
+grafo emparelhamento_corrente(grafo g);
+
+//------------------------------------------------------------------------------
+// contadores do trabalho feito pelos algoritmos e do tempo gasto em cada
+// fase, acumulados (por todas as threads) desde o início do programa ou
+// desde a última chamada de zera_estatisticas()
+//
+// os contadores só são mantidos se grafo.c for compilado com
+// -DGRAFO_ESTATISTICAS (por exemplo, make CPPFLAGS=-DGRAFO_ESTATISTICAS);
+// caso contrário o custo é nulo e todos valem 0
+//
+// e_alocacoes conta todas as chamadas a malloc() e realloc() feitas por
+// grafo.c, inclusive as de listas fora de arena, do leitor e dos buffers de
+// leitura e escrita; o que é tirado de uma arena só conta no bloco que a
+// arena aloca, e as alocações internas da libcgraph não são contadas
+
+struct estatisticas {
+
+  // emparelhamento (Hopcroft-Karp)
+  unsigned long e_fases;               // fases (buscas em largura)
+  unsigned long e_caminhos;            // caminhos aumentantes encontrados
+  unsigned long e_emparelhados_ks;     // arestas do emparelhamento inicial
+  unsigned long e_vertices_visitados;  // vértices visitados nas buscas
+  unsigned long e_arestas_examinadas;  // arestas examinadas nas buscas
+
+  // buscas e ordem perfeita de eliminação
+  unsigned long e_lex_classes;         // classes criadas pelo refinamento
+  unsigned long e_lex_movidos;         // vértices movidos de classe
+  unsigned long e_mcs_movidos;         // vértices movidos de balde
+  unsigned long e_eliminacao_testes;   // vizinhos testados contra o pai
+
+  // leitura e memória
+  unsigned long e_buscas_nome;         // chamadas de busca_vertice_nome()
+  unsigned long e_comparacoes_nome;    // comparações de nomes nessas buscas
+  unsigned long e_alocacoes;           // malloc() e realloc() de grafo.c
+  unsigned long e_bytes_alocados;      // bytes pedidos nessas chamadas
+  unsigned long e_blocos_arena;        // blocos alocados pelas arenas
+
+  // tempo (ns)
+  unsigned long e_ns_leitura;          // le_grafo(), le_grafo_binario()
+  unsigned long e_ns_emparelhamento;
+  unsigned long e_ns_busca;            // busca lexicográfica e MCS
+  unsigned long e_ns_eliminacao;       // ordem_perfeita_eliminacao()
+  unsigned long e_ns_escrita;          // escreve_grafo(), grava_grafo_binario()
+};
+
+//------------------------------------------------------------------------------
+// copia os contadores para *e
+
+void obtem_estatisticas(struct estatisticas *e);
+
+//------------------------------------------------------------------------------
+// zera os contadores
+
+void zera_estatisticas(void);
+
+//------------------------------------------------------------------------------
+// escreve os contadores em output como um objeto JSON
+//
+// devolve 1 em caso de sucesso, ou
+//         0 em caso de erro de escrita
+
+int escreve_estatisticas(FILE *output);
+
 #endif
@@ -0,0 +1,34 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "grafo.h"
+
+//------------------------------------------------------------------------------
+// uso: lote [-c] [-t n_threads] [arquivo ...]
+//
+// escreve o emparelhamento máximo (ou, com -c, se é cordal) de cada grafo
+// dos arquivos dados ou, se nenhum arquivo é dado, de cada grafo da entrada
+// padrão, usando n_threads threads (default 4)
+
+int main(int argc, char **argv) {
+
+  int operacao = 0, i = 1;
+  unsigned int n_threads = 4;
+
+  for ( ; i < argc && argv[i][0] == '-'; ++i ) {
+
+    if ( strcmp(argv[i], "-c") == 0 )
+      operacao = 1;
+    else if ( strcmp(argv[i], "-t") == 0 && i + 1 < argc )
+      n_threads = (unsigned int)atoi(argv[++i]);
+    else {
+      fprintf(stderr, "uso: %s [-c] [-t n_threads] [arquivo ...]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  int falhas = processa_lote(stdin, i < argc ? argv + i : NULL,
+                             (unsigned int)(argc - i), operacao, n_threads, stdout);
+
+  return falhas != 0;
+}